@@ -0,0 +1,569 @@
+#include "obb.hpp"
+
+#include <asp/simd.hpp>
+#include <util.hpp>
+
+#ifdef ASP_IS_X86
+# include <immintrin.h>
+#elif defined(ASP_IS_ARM64)
+# include <arm_neon.h>
+#endif
+
+#include <cmath>
+
+// The SIMD versions do every multiplication and addition separately, so the reference must not fuse them either
+#ifdef __clang__
+# pragma clang fp contract(off)
+#endif
+
+namespace blaze {
+
+void OrientedBoxBatch::resize(size_t count) {
+    for (size_t c = 0; c < 4; c++) {
+        cornerX[c].resize(count);
+        cornerY[c].resize(count);
+    }
+
+    for (size_t a = 0; a < 2; a++) {
+        axisX[a].resize(count);
+        axisY[a].resize(count);
+        origin[a].resize(count);
+    }
+}
+
+size_t OrientedBoxBatch::size() const {
+    return origin[0].size();
+}
+
+OrientedBox OrientedBoxBatch::at(size_t i) const {
+    OrientedBox box;
+
+    for (size_t c = 0; c < 4; c++) {
+        box.cornerX[c] = cornerX[c][i];
+        box.cornerY[c] = cornerY[c][i];
+    }
+
+    for (size_t a = 0; a < 2; a++) {
+        box.axisX[a] = axisX[a][i];
+        box.axisY[a] = axisY[a][i];
+        box.origin[a] = origin[a][i];
+    }
+
+    return box;
+}
+
+static void computeAxis(OrientedBox& box, size_t a, size_t corner) {
+    float x = box.cornerX[corner] - box.cornerX[0];
+    float y = box.cornerY[corner] - box.cornerY[0];
+    float len = x * x + y * y;
+
+    box.axisX[a] = x / len;
+    box.axisY[a] = y / len;
+    box.origin[a] = box.cornerX[0] * box.axisX[a] + box.cornerY[0] * box.axisY[a];
+}
+
+static OrientedBox computeOrientedBoxCS(float cx, float cy, float width, float height, float c, float s) {
+    float hw = width * 0.5f;
+    float hh = height * 0.5f;
+
+    // the box's own x and y axes, scaled to half of its size
+    float xx = c * hw;
+    float xy = s * hw;
+    float yx = -s * hh;
+    float yy = c * hh;
+
+    OrientedBox box;
+    box.cornerX[0] = cx - xx - yx;
+    box.cornerY[0] = cy - xy - yy;
+    box.cornerX[1] = cx + xx - yx;
+    box.cornerY[1] = cy + xy - yy;
+    box.cornerX[2] = cx + xx + yx;
+    box.cornerY[2] = cy + xy + yy;
+    box.cornerX[3] = cx - xx + yx;
+    box.cornerY[3] = cy - xy + yy;
+
+    computeAxis(box, 0, 1);
+    computeAxis(box, 1, 3);
+
+    return box;
+}
+
+OrientedBox computeOrientedBox(float centerX, float centerY, float width, float height, float angle) {
+    return computeOrientedBoxCS(centerX, centerY, width, height, std::cos(angle), std::sin(angle));
+}
+
+// Whether `other` overlaps the slab of `box` along both of its axes
+static bool overlaps1Way(const OrientedBox& box, const OrientedBox& other) {
+    for (size_t a = 0; a < 2; a++) {
+        float tMin = other.cornerX[0] * box.axisX[a] + other.cornerY[0] * box.axisY[a];
+        float tMax = tMin;
+
+        for (size_t c = 1; c < 4; c++) {
+            float t = other.cornerX[c] * box.axisX[a] + other.cornerY[c] * box.axisY[a];
+            tMin = t < tMin ? t : tMin;
+            tMax = t > tMax ? t : tMax;
+        }
+
+        if (tMin > 1.f + box.origin[a] || tMax < box.origin[a]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool orientedBoxesOverlap(const OrientedBox& a, const OrientedBox& b) {
+    return overlaps1Way(a, b) && overlaps1Way(b, a);
+}
+
+// Both kernels are split into a scalar pass and a vector pass. Sine and cosine are always calculated by the scalar pass,
+// and are stored in the first axis until the vector pass overwrites it.
+
+// The vector versions return the index of the first box they didn't process, the rest is left to the scalar code.
+using compute_obb_impl_t = size_t (*)(OrientedBoxBatch&, const float*, const float*, const float*, const float*);
+using overlap_obb_impl_t = size_t (*)(const OrientedBox&, const OrientedBoxBatch&, uint8_t*);
+
+static void storeBox(OrientedBoxBatch& out, size_t i, const OrientedBox& box) {
+    for (size_t c = 0; c < 4; c++) {
+        out.cornerX[c][i] = box.cornerX[c];
+        out.cornerY[c][i] = box.cornerY[c];
+    }
+
+    for (size_t a = 0; a < 2; a++) {
+        out.axisX[a][i] = box.axisX[a];
+        out.axisY[a][i] = box.axisY[a];
+        out.origin[a][i] = box.origin[a];
+    }
+}
+
+// Computes boxes [begin, count) one at a time
+static void computeOrientedBoxesScalar(
+    OrientedBoxBatch& out, const float* cx, const float* cy, const float* w, const float* h, size_t begin, size_t count
+) {
+    for (size_t i = begin; i < count; i++) {
+        storeBox(out, i, computeOrientedBoxCS(cx[i], cy[i], w[i], h[i], out.axisX[0][i], out.axisY[0][i]));
+    }
+}
+
+#ifdef ASP_IS_X86
+
+static size_t BLAZE_AVX2 computeOrientedBoxesAVX2(
+    OrientedBoxBatch& out, const float* cx, const float* cy, const float* w, const float* h
+) {
+    size_t count = out.size();
+    __m256 half = _mm256_set1_ps(0.5f);
+    __m256 signBit = _mm256_set1_ps(-0.f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 c = _mm256_loadu_ps(out.axisX[0].data() + i);
+        __m256 s = _mm256_loadu_ps(out.axisY[0].data() + i);
+        __m256 hw = _mm256_mul_ps(_mm256_loadu_ps(w + i), half);
+        __m256 hh = _mm256_mul_ps(_mm256_loadu_ps(h + i), half);
+        __m256 x = _mm256_loadu_ps(cx + i);
+        __m256 y = _mm256_loadu_ps(cy + i);
+
+        __m256 xx = _mm256_mul_ps(c, hw);
+        __m256 xy = _mm256_mul_ps(s, hw);
+        __m256 yx = _mm256_mul_ps(_mm256_xor_ps(s, signBit), hh);
+        __m256 yy = _mm256_mul_ps(c, hh);
+
+        __m256 c0x = _mm256_sub_ps(_mm256_sub_ps(x, xx), yx);
+        __m256 c0y = _mm256_sub_ps(_mm256_sub_ps(y, xy), yy);
+        __m256 c1x = _mm256_sub_ps(_mm256_add_ps(x, xx), yx);
+        __m256 c1y = _mm256_sub_ps(_mm256_add_ps(y, xy), yy);
+        __m256 c2x = _mm256_add_ps(_mm256_add_ps(x, xx), yx);
+        __m256 c2y = _mm256_add_ps(_mm256_add_ps(y, xy), yy);
+        __m256 c3x = _mm256_add_ps(_mm256_sub_ps(x, xx), yx);
+        __m256 c3y = _mm256_add_ps(_mm256_sub_ps(y, xy), yy);
+
+        _mm256_storeu_ps(out.cornerX[0].data() + i, c0x);
+        _mm256_storeu_ps(out.cornerY[0].data() + i, c0y);
+        _mm256_storeu_ps(out.cornerX[1].data() + i, c1x);
+        _mm256_storeu_ps(out.cornerY[1].data() + i, c1y);
+        _mm256_storeu_ps(out.cornerX[2].data() + i, c2x);
+        _mm256_storeu_ps(out.cornerY[2].data() + i, c2y);
+        _mm256_storeu_ps(out.cornerX[3].data() + i, c3x);
+        _mm256_storeu_ps(out.cornerY[3].data() + i, c3y);
+
+        __m256 ends[2][2] = {{c1x, c1y}, {c3x, c3y}};
+        for (size_t a = 0; a < 2; a++) {
+            __m256 ax = _mm256_sub_ps(ends[a][0], c0x);
+            __m256 ay = _mm256_sub_ps(ends[a][1], c0y);
+            __m256 len = _mm256_add_ps(_mm256_mul_ps(ax, ax), _mm256_mul_ps(ay, ay));
+            ax = _mm256_div_ps(ax, len);
+            ay = _mm256_div_ps(ay, len);
+
+            _mm256_storeu_ps(out.axisX[a].data() + i, ax);
+            _mm256_storeu_ps(out.axisY[a].data() + i, ay);
+            _mm256_storeu_ps(out.origin[a].data() + i, _mm256_add_ps(_mm256_mul_ps(c0x, ax), _mm256_mul_ps(c0y, ay)));
+        }
+    }
+
+    return i;
+}
+
+// All-ones in every lane where the corners (cx, cy) overlap the slab of axis (ax, ay) with the given origin
+static inline __m256 BLAZE_AVX2 slabOverlapAVX2(const __m256* cx, const __m256* cy, __m256 ax, __m256 ay, __m256 origin) {
+    __m256 tMin = _mm256_add_ps(_mm256_mul_ps(cx[0], ax), _mm256_mul_ps(cy[0], ay));
+    __m256 tMax = tMin;
+
+    for (size_t c = 1; c < 4; c++) {
+        __m256 t = _mm256_add_ps(_mm256_mul_ps(cx[c], ax), _mm256_mul_ps(cy[c], ay));
+        tMin = _mm256_min_ps(t, tMin);
+        tMax = _mm256_max_ps(t, tMax);
+    }
+
+    __m256 separated = _mm256_or_ps(
+        _mm256_cmp_ps(tMin, _mm256_add_ps(_mm256_set1_ps(1.f), origin), _CMP_GT_OQ),
+        _mm256_cmp_ps(tMax, origin, _CMP_LT_OQ)
+    );
+
+    return _mm256_xor_ps(separated, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+}
+
+static size_t BLAZE_AVX2 overlapOrientedBoxesAVX2(const OrientedBox& box, const OrientedBoxBatch& boxes, uint8_t* out) {
+    size_t count = boxes.size();
+
+    __m256 boxCx[4], boxCy[4];
+    for (size_t c = 0; c < 4; c++) {
+        boxCx[c] = _mm256_set1_ps(box.cornerX[c]);
+        boxCy[c] = _mm256_set1_ps(box.cornerY[c]);
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 cx[4], cy[4];
+        for (size_t c = 0; c < 4; c++) {
+            cx[c] = _mm256_loadu_ps(boxes.cornerX[c].data() + i);
+            cy[c] = _mm256_loadu_ps(boxes.cornerY[c].data() + i);
+        }
+
+        __m256 overlap = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (size_t a = 0; a < 2; a++) {
+            // other boxes against the axes of this box
+            overlap = _mm256_and_ps(overlap, slabOverlapAVX2(
+                cx, cy, _mm256_set1_ps(box.axisX[a]), _mm256_set1_ps(box.axisY[a]), _mm256_set1_ps(box.origin[a])
+            ));
+        }
+
+        for (size_t a = 0; a < 2; a++) {
+            // this box against the axes of the other boxes
+            overlap = _mm256_and_ps(overlap, slabOverlapAVX2(
+                boxCx, boxCy,
+                _mm256_loadu_ps(boxes.axisX[a].data() + i),
+                _mm256_loadu_ps(boxes.axisY[a].data() + i),
+                _mm256_loadu_ps(boxes.origin[a].data() + i)
+            ));
+        }
+
+        int mask = _mm256_movemask_ps(overlap);
+        for (size_t j = 0; j < 8; j++) {
+            out[i + j] = (mask >> j) & 1;
+        }
+    }
+
+    return i;
+}
+
+static size_t BLAZE_SSE2 computeOrientedBoxesSSE2(
+    OrientedBoxBatch& out, const float* cx, const float* cy, const float* w, const float* h
+) {
+    size_t count = out.size();
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 signBit = _mm_set1_ps(-0.f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 c = _mm_loadu_ps(out.axisX[0].data() + i);
+        __m128 s = _mm_loadu_ps(out.axisY[0].data() + i);
+        __m128 hw = _mm_mul_ps(_mm_loadu_ps(w + i), half);
+        __m128 hh = _mm_mul_ps(_mm_loadu_ps(h + i), half);
+        __m128 x = _mm_loadu_ps(cx + i);
+        __m128 y = _mm_loadu_ps(cy + i);
+
+        __m128 xx = _mm_mul_ps(c, hw);
+        __m128 xy = _mm_mul_ps(s, hw);
+        __m128 yx = _mm_mul_ps(_mm_xor_ps(s, signBit), hh);
+        __m128 yy = _mm_mul_ps(c, hh);
+
+        __m128 c0x = _mm_sub_ps(_mm_sub_ps(x, xx), yx);
+        __m128 c0y = _mm_sub_ps(_mm_sub_ps(y, xy), yy);
+        __m128 c1x = _mm_sub_ps(_mm_add_ps(x, xx), yx);
+        __m128 c1y = _mm_sub_ps(_mm_add_ps(y, xy), yy);
+        __m128 c2x = _mm_add_ps(_mm_add_ps(x, xx), yx);
+        __m128 c2y = _mm_add_ps(_mm_add_ps(y, xy), yy);
+        __m128 c3x = _mm_add_ps(_mm_sub_ps(x, xx), yx);
+        __m128 c3y = _mm_add_ps(_mm_sub_ps(y, xy), yy);
+
+        _mm_storeu_ps(out.cornerX[0].data() + i, c0x);
+        _mm_storeu_ps(out.cornerY[0].data() + i, c0y);
+        _mm_storeu_ps(out.cornerX[1].data() + i, c1x);
+        _mm_storeu_ps(out.cornerY[1].data() + i, c1y);
+        _mm_storeu_ps(out.cornerX[2].data() + i, c2x);
+        _mm_storeu_ps(out.cornerY[2].data() + i, c2y);
+        _mm_storeu_ps(out.cornerX[3].data() + i, c3x);
+        _mm_storeu_ps(out.cornerY[3].data() + i, c3y);
+
+        __m128 ends[2][2] = {{c1x, c1y}, {c3x, c3y}};
+        for (size_t a = 0; a < 2; a++) {
+            __m128 ax = _mm_sub_ps(ends[a][0], c0x);
+            __m128 ay = _mm_sub_ps(ends[a][1], c0y);
+            __m128 len = _mm_add_ps(_mm_mul_ps(ax, ax), _mm_mul_ps(ay, ay));
+            ax = _mm_div_ps(ax, len);
+            ay = _mm_div_ps(ay, len);
+
+            _mm_storeu_ps(out.axisX[a].data() + i, ax);
+            _mm_storeu_ps(out.axisY[a].data() + i, ay);
+            _mm_storeu_ps(out.origin[a].data() + i, _mm_add_ps(_mm_mul_ps(c0x, ax), _mm_mul_ps(c0y, ay)));
+        }
+    }
+
+    return i;
+}
+
+static inline __m128 BLAZE_SSE2 slabOverlapSSE2(const __m128* cx, const __m128* cy, __m128 ax, __m128 ay, __m128 origin) {
+    __m128 tMin = _mm_add_ps(_mm_mul_ps(cx[0], ax), _mm_mul_ps(cy[0], ay));
+    __m128 tMax = tMin;
+
+    for (size_t c = 1; c < 4; c++) {
+        __m128 t = _mm_add_ps(_mm_mul_ps(cx[c], ax), _mm_mul_ps(cy[c], ay));
+        tMin = _mm_min_ps(t, tMin);
+        tMax = _mm_max_ps(t, tMax);
+    }
+
+    __m128 separated = _mm_or_ps(
+        _mm_cmpgt_ps(tMin, _mm_add_ps(_mm_set1_ps(1.f), origin)),
+        _mm_cmplt_ps(tMax, origin)
+    );
+
+    return _mm_xor_ps(separated, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+}
+
+static size_t BLAZE_SSE2 overlapOrientedBoxesSSE2(const OrientedBox& box, const OrientedBoxBatch& boxes, uint8_t* out) {
+    size_t count = boxes.size();
+
+    __m128 boxCx[4], boxCy[4];
+    for (size_t c = 0; c < 4; c++) {
+        boxCx[c] = _mm_set1_ps(box.cornerX[c]);
+        boxCy[c] = _mm_set1_ps(box.cornerY[c]);
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 cx[4], cy[4];
+        for (size_t c = 0; c < 4; c++) {
+            cx[c] = _mm_loadu_ps(boxes.cornerX[c].data() + i);
+            cy[c] = _mm_loadu_ps(boxes.cornerY[c].data() + i);
+        }
+
+        __m128 overlap = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (size_t a = 0; a < 2; a++) {
+            overlap = _mm_and_ps(overlap, slabOverlapSSE2(
+                cx, cy, _mm_set1_ps(box.axisX[a]), _mm_set1_ps(box.axisY[a]), _mm_set1_ps(box.origin[a])
+            ));
+        }
+
+        for (size_t a = 0; a < 2; a++) {
+            overlap = _mm_and_ps(overlap, slabOverlapSSE2(
+                boxCx, boxCy,
+                _mm_loadu_ps(boxes.axisX[a].data() + i),
+                _mm_loadu_ps(boxes.axisY[a].data() + i),
+                _mm_loadu_ps(boxes.origin[a].data() + i)
+            ));
+        }
+
+        int mask = _mm_movemask_ps(overlap);
+        for (size_t j = 0; j < 4; j++) {
+            out[i + j] = (mask >> j) & 1;
+        }
+    }
+
+    return i;
+}
+
+#elif defined(ASP_IS_ARM64)
+
+static size_t computeOrientedBoxesNEON(
+    OrientedBoxBatch& out, const float* cx, const float* cy, const float* w, const float* h
+) {
+    size_t count = out.size();
+    float32x4_t half = vdupq_n_f32(0.5f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t c = vld1q_f32(out.axisX[0].data() + i);
+        float32x4_t s = vld1q_f32(out.axisY[0].data() + i);
+        float32x4_t hw = vmulq_f32(vld1q_f32(w + i), half);
+        float32x4_t hh = vmulq_f32(vld1q_f32(h + i), half);
+        float32x4_t x = vld1q_f32(cx + i);
+        float32x4_t y = vld1q_f32(cy + i);
+
+        float32x4_t xx = vmulq_f32(c, hw);
+        float32x4_t xy = vmulq_f32(s, hw);
+        float32x4_t yx = vmulq_f32(vnegq_f32(s), hh);
+        float32x4_t yy = vmulq_f32(c, hh);
+
+        float32x4_t c0x = vsubq_f32(vsubq_f32(x, xx), yx);
+        float32x4_t c0y = vsubq_f32(vsubq_f32(y, xy), yy);
+        float32x4_t c1x = vsubq_f32(vaddq_f32(x, xx), yx);
+        float32x4_t c1y = vsubq_f32(vaddq_f32(y, xy), yy);
+        float32x4_t c2x = vaddq_f32(vaddq_f32(x, xx), yx);
+        float32x4_t c2y = vaddq_f32(vaddq_f32(y, xy), yy);
+        float32x4_t c3x = vaddq_f32(vsubq_f32(x, xx), yx);
+        float32x4_t c3y = vaddq_f32(vsubq_f32(y, xy), yy);
+
+        vst1q_f32(out.cornerX[0].data() + i, c0x);
+        vst1q_f32(out.cornerY[0].data() + i, c0y);
+        vst1q_f32(out.cornerX[1].data() + i, c1x);
+        vst1q_f32(out.cornerY[1].data() + i, c1y);
+        vst1q_f32(out.cornerX[2].data() + i, c2x);
+        vst1q_f32(out.cornerY[2].data() + i, c2y);
+        vst1q_f32(out.cornerX[3].data() + i, c3x);
+        vst1q_f32(out.cornerY[3].data() + i, c3y);
+
+        float32x4_t ends[2][2] = {{c1x, c1y}, {c3x, c3y}};
+        for (size_t a = 0; a < 2; a++) {
+            float32x4_t ax = vsubq_f32(ends[a][0], c0x);
+            float32x4_t ay = vsubq_f32(ends[a][1], c0y);
+            float32x4_t len = vaddq_f32(vmulq_f32(ax, ax), vmulq_f32(ay, ay));
+            ax = vdivq_f32(ax, len);
+            ay = vdivq_f32(ay, len);
+
+            vst1q_f32(out.axisX[a].data() + i, ax);
+            vst1q_f32(out.axisY[a].data() + i, ay);
+            vst1q_f32(out.origin[a].data() + i, vaddq_f32(vmulq_f32(c0x, ax), vmulq_f32(c0y, ay)));
+        }
+    }
+
+    return i;
+}
+
+// vminq/vmaxq propagate NaNs, unlike the reference, so compare and select instead
+static inline uint32x4_t slabOverlapNEON(const float32x4_t* cx, const float32x4_t* cy, float32x4_t ax, float32x4_t ay, float32x4_t origin) {
+    float32x4_t tMin = vaddq_f32(vmulq_f32(cx[0], ax), vmulq_f32(cy[0], ay));
+    float32x4_t tMax = tMin;
+
+    for (size_t c = 1; c < 4; c++) {
+        float32x4_t t = vaddq_f32(vmulq_f32(cx[c], ax), vmulq_f32(cy[c], ay));
+        tMin = vbslq_f32(vcltq_f32(t, tMin), t, tMin);
+        tMax = vbslq_f32(vcgtq_f32(t, tMax), t, tMax);
+    }
+
+    uint32x4_t separated = vorrq_u32(
+        vcgtq_f32(tMin, vaddq_f32(vdupq_n_f32(1.f), origin)),
+        vcltq_f32(tMax, origin)
+    );
+
+    return vmvnq_u32(separated);
+}
+
+static size_t overlapOrientedBoxesNEON(const OrientedBox& box, const OrientedBoxBatch& boxes, uint8_t* out) {
+    size_t count = boxes.size();
+
+    float32x4_t boxCx[4], boxCy[4];
+    for (size_t c = 0; c < 4; c++) {
+        boxCx[c] = vdupq_n_f32(box.cornerX[c]);
+        boxCy[c] = vdupq_n_f32(box.cornerY[c]);
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t cx[4], cy[4];
+        for (size_t c = 0; c < 4; c++) {
+            cx[c] = vld1q_f32(boxes.cornerX[c].data() + i);
+            cy[c] = vld1q_f32(boxes.cornerY[c].data() + i);
+        }
+
+        uint32x4_t overlap = vdupq_n_u32(0xffffffff);
+
+        for (size_t a = 0; a < 2; a++) {
+            overlap = vandq_u32(overlap, slabOverlapNEON(
+                cx, cy, vdupq_n_f32(box.axisX[a]), vdupq_n_f32(box.axisY[a]), vdupq_n_f32(box.origin[a])
+            ));
+        }
+
+        for (size_t a = 0; a < 2; a++) {
+            overlap = vandq_u32(overlap, slabOverlapNEON(
+                boxCx, boxCy,
+                vld1q_f32(boxes.axisX[a].data() + i),
+                vld1q_f32(boxes.axisY[a].data() + i),
+                vld1q_f32(boxes.origin[a].data() + i)
+            ));
+        }
+
+        uint32_t lanes[4];
+        vst1q_u32(lanes, overlap);
+        for (size_t j = 0; j < 4; j++) {
+            out[i + j] = lanes[j] & 1;
+        }
+    }
+
+    return i;
+}
+
+#endif
+
+static size_t computeOrientedBoxesNone(OrientedBoxBatch&, const float*, const float*, const float*, const float*) {
+    return 0;
+}
+
+static size_t overlapOrientedBoxesNone(const OrientedBox&, const OrientedBoxBatch&, uint8_t*) {
+    return 0;
+}
+
+struct ObbImpls {
+    compute_obb_impl_t compute;
+    overlap_obb_impl_t overlap;
+};
+
+static ObbImpls chooseImpl() {
+#ifdef ASP_IS_X86
+    auto& features = asp::simd::getFeatures();
+
+    if (features.avx2) {
+        return {&computeOrientedBoxesAVX2, &overlapOrientedBoxesAVX2};
+    } else if (features.sse2) {
+        return {&computeOrientedBoxesSSE2, &overlapOrientedBoxesSSE2};
+    }
+
+    return {&computeOrientedBoxesNone, &overlapOrientedBoxesNone};
+#elif defined(ASP_IS_ARM64)
+    return {&computeOrientedBoxesNEON, &overlapOrientedBoxesNEON};
+#else
+    return {&computeOrientedBoxesNone, &overlapOrientedBoxesNone};
+#endif
+}
+
+static const ObbImpls& impls() {
+    static const ObbImpls impls = chooseImpl();
+    return impls;
+}
+
+void computeOrientedBoxes(
+    OrientedBoxBatch& out,
+    const float* centerX, const float* centerY, const float* width, const float* height, const float* angle,
+    size_t count
+) {
+    out.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        out.axisX[0][i] = std::cos(angle[i]);
+        out.axisY[0][i] = std::sin(angle[i]);
+    }
+
+    size_t done = impls().compute(out, centerX, centerY, width, height);
+    computeOrientedBoxesScalar(out, centerX, centerY, width, height, done, count);
+}
+
+void overlapOrientedBoxes(const OrientedBox& box, const OrientedBoxBatch& boxes, uint8_t* out) {
+    size_t done = impls().overlap(box, boxes, out);
+
+    for (size_t i = done; i < boxes.size(); i++) {
+        out[i] = orientedBoxesOverlap(box, boxes.at(i));
+    }
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace blaze {
+    // A rotated rectangle in the same form as the game's OBB2D: the four corners, and the two edges going out of the first corner,
+    // scaled so that projecting the box onto edge `a` gives the range [origin[a], origin[a] + 1].
+    struct OrientedBox {
+        float cornerX[4], cornerY[4];
+        float axisX[2], axisY[2];
+        float origin[2];
+    };
+
+    // Many oriented boxes stored as separate arrays, so that they can be processed with SIMD.
+    struct OrientedBoxBatch {
+        std::vector<float> cornerX[4], cornerY[4];
+        std::vector<float> axisX[2], axisY[2];
+        std::vector<float> origin[2];
+
+        void resize(size_t count);
+        size_t size() const;
+        OrientedBox at(size_t i) const;
+    };
+
+    // Reference implementations, one box at a time. `angle` is in radians.
+    OrientedBox computeOrientedBox(float centerX, float centerY, float width, float height, float angle);
+    bool orientedBoxesOverlap(const OrientedBox& a, const OrientedBox& b);
+
+    // Fills `out` (resized to `count`) with the boxes for the given centers, sizes and angles, same as `computeOrientedBox`.
+    void computeOrientedBoxes(
+        OrientedBoxBatch& out,
+        const float* centerX, const float* centerY, const float* width, const float* height, const float* angle,
+        size_t count
+    );
+
+    // Tests `box` against every box in `boxes`, `out[i]` is set to 1 if it overlaps the i-th one and to 0 otherwise.
+    // Same results as `orientedBoxesOverlap`.
+    void overlapOrientedBoxes(const OrientedBox& box, const OrientedBoxBatch& boxes, uint8_t* out);
+}
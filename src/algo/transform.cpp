@@ -0,0 +1,148 @@
+#include "transform.hpp"
+
+#include <asp/simd.hpp>
+#include <util.hpp>
+
+#ifdef ASP_IS_X86
+# include <immintrin.h>
+#elif defined(ASP_IS_ARM64)
+# include <arm_neon.h>
+#endif
+
+namespace blaze {
+
+using rotate_positions_impl_t = void (*)(double*, double*, const double*, const double*, size_t, const RotationTransform&);
+
+static void rotatePositionsScalar(double* x, double* y, const double* offsetX, const double* offsetY, size_t count, const RotationTransform& t) {
+    for (size_t i = 0; i < count; i++) {
+        float xo = offsetX[i];
+        float yo = offsetY[i];
+        float px = x[i] - xo - t.centerX;
+        float py = y[i] - yo - t.centerY;
+
+        float rx = (float)((double)t.a * px + (double)t.c * py + t.tx);
+        float ry = (float)((double)t.b * px + (double)t.d * py + t.ty);
+
+        x[i] = offsetX[i] + rx + t.moveX;
+        y[i] = offsetY[i] + ry + t.moveY;
+    }
+}
+
+#ifdef ASP_IS_X86
+
+// rounds every lane to a float and back
+static inline __m256d BLAZE_AVX2 roundToFloat(__m256d v) {
+    return _mm256_cvtps_pd(_mm256_cvtpd_ps(v));
+}
+
+static void BLAZE_AVX2 rotatePositionsAVX2(double* x, double* y, const double* offsetX, const double* offsetY, size_t count, const RotationTransform& t) {
+    __m256d a = _mm256_set1_pd(t.a), b = _mm256_set1_pd(t.b), c = _mm256_set1_pd(t.c), d = _mm256_set1_pd(t.d);
+    __m256d tx = _mm256_set1_pd(t.tx), ty = _mm256_set1_pd(t.ty);
+    __m256d cx = _mm256_set1_pd(t.centerX), cy = _mm256_set1_pd(t.centerY);
+    __m256d mx = _mm256_set1_pd(t.moveX), my = _mm256_set1_pd(t.moveY);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d ox = _mm256_loadu_pd(offsetX + i);
+        __m256d oy = _mm256_loadu_pd(offsetY + i);
+
+        __m256d px = roundToFloat(_mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(x + i), roundToFloat(ox)), cx));
+        __m256d py = roundToFloat(_mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(y + i), roundToFloat(oy)), cy));
+
+        __m256d rx = roundToFloat(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(a, px), _mm256_mul_pd(c, py)), tx));
+        __m256d ry = roundToFloat(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(b, px), _mm256_mul_pd(d, py)), ty));
+
+        _mm256_storeu_pd(x + i, _mm256_add_pd(_mm256_add_pd(ox, rx), mx));
+        _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_add_pd(oy, ry), my));
+    }
+
+    rotatePositionsScalar(x + i, y + i, offsetX + i, offsetY + i, count - i, t);
+}
+
+static inline __m128d BLAZE_SSE2 roundToFloat(__m128d v) {
+    return _mm_cvtps_pd(_mm_cvtpd_ps(v));
+}
+
+static void BLAZE_SSE2 rotatePositionsSSE2(double* x, double* y, const double* offsetX, const double* offsetY, size_t count, const RotationTransform& t) {
+    __m128d a = _mm_set1_pd(t.a), b = _mm_set1_pd(t.b), c = _mm_set1_pd(t.c), d = _mm_set1_pd(t.d);
+    __m128d tx = _mm_set1_pd(t.tx), ty = _mm_set1_pd(t.ty);
+    __m128d cx = _mm_set1_pd(t.centerX), cy = _mm_set1_pd(t.centerY);
+    __m128d mx = _mm_set1_pd(t.moveX), my = _mm_set1_pd(t.moveY);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d ox = _mm_loadu_pd(offsetX + i);
+        __m128d oy = _mm_loadu_pd(offsetY + i);
+
+        __m128d px = roundToFloat(_mm_sub_pd(_mm_sub_pd(_mm_loadu_pd(x + i), roundToFloat(ox)), cx));
+        __m128d py = roundToFloat(_mm_sub_pd(_mm_sub_pd(_mm_loadu_pd(y + i), roundToFloat(oy)), cy));
+
+        __m128d rx = roundToFloat(_mm_add_pd(_mm_add_pd(_mm_mul_pd(a, px), _mm_mul_pd(c, py)), tx));
+        __m128d ry = roundToFloat(_mm_add_pd(_mm_add_pd(_mm_mul_pd(b, px), _mm_mul_pd(d, py)), ty));
+
+        _mm_storeu_pd(x + i, _mm_add_pd(_mm_add_pd(ox, rx), mx));
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_add_pd(oy, ry), my));
+    }
+
+    rotatePositionsScalar(x + i, y + i, offsetX + i, offsetY + i, count - i, t);
+}
+
+#elif defined(ASP_IS_ARM64)
+
+static inline float64x2_t roundToFloat(float64x2_t v) {
+    return vcvt_f64_f32(vcvt_f32_f64(v));
+}
+
+static void rotatePositionsNEON(double* x, double* y, const double* offsetX, const double* offsetY, size_t count, const RotationTransform& t) {
+    float64x2_t a = vdupq_n_f64(t.a), b = vdupq_n_f64(t.b), c = vdupq_n_f64(t.c), d = vdupq_n_f64(t.d);
+    float64x2_t tx = vdupq_n_f64(t.tx), ty = vdupq_n_f64(t.ty);
+    float64x2_t cx = vdupq_n_f64(t.centerX), cy = vdupq_n_f64(t.centerY);
+    float64x2_t mx = vdupq_n_f64(t.moveX), my = vdupq_n_f64(t.moveY);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t ox = vld1q_f64(offsetX + i);
+        float64x2_t oy = vld1q_f64(offsetY + i);
+
+        float64x2_t px = roundToFloat(vsubq_f64(vsubq_f64(vld1q_f64(x + i), roundToFloat(ox)), cx));
+        float64x2_t py = roundToFloat(vsubq_f64(vsubq_f64(vld1q_f64(y + i), roundToFloat(oy)), cy));
+
+        // separate multiplies and adds, the products are exact so fusing them wouldn't change anything anyway
+        float64x2_t rx = roundToFloat(vaddq_f64(vaddq_f64(vmulq_f64(a, px), vmulq_f64(c, py)), tx));
+        float64x2_t ry = roundToFloat(vaddq_f64(vaddq_f64(vmulq_f64(b, px), vmulq_f64(d, py)), ty));
+
+        vst1q_f64(x + i, vaddq_f64(vaddq_f64(ox, rx), mx));
+        vst1q_f64(y + i, vaddq_f64(vaddq_f64(oy, ry), my));
+    }
+
+    rotatePositionsScalar(x + i, y + i, offsetX + i, offsetY + i, count - i, t);
+}
+
+#endif
+
+static rotate_positions_impl_t chooseImpl() {
+#ifdef ASP_IS_X86
+    auto& features = asp::simd::getFeatures();
+
+    if (features.avx2) {
+        return &rotatePositionsAVX2;
+    } else if (features.sse2) {
+        return &rotatePositionsSSE2;
+    }
+
+    return &rotatePositionsScalar;
+#elif defined(ASP_IS_ARM64)
+    return &rotatePositionsNEON;
+#else
+    return &rotatePositionsScalar;
+#endif
+}
+
+void rotatePositions(double* x, double* y, const double* offsetX, const double* offsetY, size_t count, const RotationTransform& t) {
+    // called from worker threads, so pick the implementation in a thread-safe way
+    static const rotate_positions_impl_t impl = chooseImpl();
+
+    impl(x, y, offsetX, offsetY, count, t);
+}
+
+}
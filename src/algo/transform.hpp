@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+namespace blaze {
+    // Everything a rotation trigger applies to the positions of a group, see `rotatePositions`.
+    struct RotationTransform {
+        // the area transform node's world transform (a CCAffineTransform)
+        float a, b, c, d, tx, ty;
+        // position of the center object
+        float centerX, centerY;
+        // move that the trigger claimed for the group
+        float moveX, moveY;
+    };
+
+    // Rotates object positions stored as separate arrays, giving the exact same results as the game's per object code:
+    // the position relative to the center is rounded to a float, transformed in double precision like
+    // `__CCPointApplyAffineTransform` does, rounded again and added back to the (unrounded) offset together with the move.
+    void rotatePositions(double* x, double* y, const double* offsetX, const double* offsetY, size_t count, const RotationTransform& t);
+}
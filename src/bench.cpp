@@ -3,7 +3,24 @@
 #include <TaskTimer.hpp>
 
 #include <hooks/load/spriteframes.hpp>
+#include <hooks/load/framecache.hpp>
+#include <hooks/load/plist.hpp>
+#include <hooks/CCSpriteBatchNode.hpp>
+#include <hooks/CCSpriteFrameCache.hpp>
+#include <hooks/GJBaseGameLayer.hpp>
+#include <algo/crc32.hpp>
+#include <algo/obb.hpp>
+#include <algo/transform.hpp>
+#include <util/string.hpp>
 #include <fpff.hpp>
+#include <manager.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
 
 using namespace geode::prelude;
 
@@ -32,6 +49,9 @@ static void benchSpriteFrames() {
         return;
     }
 
+    // parsing modifies the buffer, so checksum it beforehand
+    auto checksum = blaze::crc32(data, size);
+
     auto spf = blaze::parseSpriteFrames(data, size);
     if (!spf) {
         log::error("Error: failed to parse sprite frames: {}", spf.unwrapErr());
@@ -44,6 +64,29 @@ static void benchSpriteFrames() {
 
     BLAZE_TIMER_END();
 
+    // Binary cache, make sure the file exists first
+
+    blaze::cacheSpriteFrames(*spf.unwrap(), checksum, size);
+
+    CCSpriteFrameCache::purgeSharedSpriteFrameCache();
+    cache = CCSpriteFrameCache::get();
+
+    {
+        BLAZE_TIMER_START("Load sprite frames (binary cache)");
+
+        auto cached = blaze::loadCachedSpriteFrames(checksum, size);
+        if (!cached) {
+            log::error("Error: failed to load cached sprite frames");
+            return;
+        }
+
+        BLAZE_TIMER_STEP("Add sprite frames (binary cache)");
+
+        blaze::addSpriteFrames(*cached, texture);
+
+        BLAZE_TIMER_END();
+    }
+
     // Now test vanilla functions :)
 
     CCSpriteFrameCache::purgeSharedSpriteFrameCache();
@@ -68,8 +111,780 @@ static void benchSpriteFrames() {
     }
 }
 
+static bool sameFrame(const blaze::SpriteFrame& a, const blaze::SpriteFrame& b) {
+    if (strcmp(a.name, b.name) != 0 || a.aliases.size() != b.aliases.size()) return false;
+
+    for (size_t i = 0; i < a.aliases.size(); i++) {
+        if (strcmp(a.aliases[i], b.aliases[i]) != 0) return false;
+    }
+
+    return a.offset.equals(b.offset)
+        && a.sourceSize.equals(b.sourceSize)
+        && a.textureRect.equalsToRect(b.textureRect)
+        && a.textureRotated == b.textureRotated;
+}
+
+static void benchPlistParsers() {
+    auto fp = blaze::fullPathForFilename("GJ_GameSheet03.plist", false);
+    unsigned long size;
+    auto data = CCFileUtils::get()->getFileData(fp.c_str(), "rt", &size);
+
+    if (!size || !data) {
+        log::error("Error: failed to load sprite frames");
+        return;
+    }
+
+    // both parsers modify the buffer, give each one its own copy
+    std::vector<uint8_t> pugiBuf(data, data + size), streamingBuf(data, data + size);
+    delete[] data;
+
+    BLAZE_TIMER_START("Parse GJ_GameSheet03.plist (pugixml)");
+    auto pugiRes = blaze::parseSpriteFramesPugi(pugiBuf.data(), size);
+    BLAZE_TIMER_STEP("Parse GJ_GameSheet03.plist (streaming)");
+    auto streamingRes = blaze::parseSpriteFramesStreaming(streamingBuf.data(), size);
+    BLAZE_TIMER_END();
+
+    if (!pugiRes || !streamingRes) {
+        log::error("Error: failed to parse sprite frames: {}", !pugiRes ? pugiRes.unwrapErr() : streamingRes.unwrapErr());
+        return;
+    }
+
+    auto& expected = *pugiRes.unwrap();
+    auto& actual = *streamingRes.unwrap();
+
+    if (expected.metadata.format != actual.metadata.format
+        || strcmp(expected.metadata.textureFileName, actual.metadata.textureFileName) != 0
+        || expected.frames.size() != actual.frames.size()
+    ) {
+        log::error("Streaming parser mismatch: {} frames (format {}) vs {} frames (format {})",
+            actual.frames.size(), actual.metadata.format, expected.frames.size(), expected.metadata.format);
+        return;
+    }
+
+    for (size_t i = 0; i < expected.frames.size(); i++) {
+        if (!sameFrame(expected.frames[i], actual.frames[i])) {
+            log::error("Streaming parser mismatch at frame {} ({})", i, expected.frames[i].name);
+            return;
+        }
+    }
+
+    log::info("Streaming parser matches pugixml ({} frames)", expected.frames.size());
+}
+
+static bool sameObject(CCObject* a, CCObject* b);
+
+static bool sameDict(CCDictionary* a, CCDictionary* b) {
+    if (a->count() != b->count()) return false;
+
+    // cocos keeps insertion order, so both dictionaries must iterate the same way
+    auto ea = a->m_pElements, eb = b->m_pElements;
+    for (; ea && eb; ea = static_cast<CCDictElement*>(ea->hh.next), eb = static_cast<CCDictElement*>(eb->hh.next)) {
+        if (strcmp(ea->getStrKey(), eb->getStrKey()) != 0 || !sameObject(ea->getObject(), eb->getObject())) {
+            return false;
+        }
+    }
+
+    return !ea && !eb;
+}
+
+static bool sameObject(CCObject* a, CCObject* b) {
+    if (auto sa = typeinfo_cast<CCString*>(a)) {
+        auto sb = typeinfo_cast<CCString*>(b);
+        return sb && sa->m_sString == sb->m_sString;
+    } else if (auto da = typeinfo_cast<CCDictionary*>(a)) {
+        auto db = typeinfo_cast<CCDictionary*>(b);
+        return db && sameDict(da, db);
+    } else if (auto aa = typeinfo_cast<CCArray*>(a)) {
+        auto ab = typeinfo_cast<CCArray*>(b);
+        if (!ab || aa->count() != ab->count()) return false;
+
+        for (unsigned int i = 0; i < aa->count(); i++) {
+            if (!sameObject(aa->objectAtIndex(i), ab->objectAtIndex(i))) return false;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+static void benchPlistDictionary() {
+    // find the biggest plist that the game ships with
+    std::filesystem::path biggest;
+    uintmax_t biggestSize = 0;
+
+    std::error_code ec;
+    for (auto& entry : std::filesystem::directory_iterator(dirs::getResourcesDir(), ec)) {
+        if (entry.path().extension() != ".plist") continue;
+
+        auto size = entry.file_size(ec);
+        if (!ec && size > biggestSize) {
+            biggest = entry.path();
+            biggestSize = size;
+        }
+    }
+
+    if (biggest.empty()) {
+        log::error("Error: failed to find any plists");
+        return;
+    }
+
+    auto fp = utils::string::pathToString(biggest);
+    auto name = utils::string::pathToString(biggest.filename());
+
+    size_t size = 0;
+    auto data = LoadManager::get().readFile(fp.c_str(), size, true);
+    if (!data || size == 0) {
+        log::error("Error: failed to read {}", fp);
+        return;
+    }
+
+    BLAZE_TIMER_START(fmt::format("Parse {} ({} KiB, cocos)", name, size / 1024));
+    auto expected = CCFileUtils::get()->createCCDictionaryWithContentsOfFile(gd::string{fp.c_str()});
+    BLAZE_TIMER_STEP(fmt::format("Parse {} ({} KiB, blaze)", name, size / 1024));
+    auto actual = blaze::parsePlistDictionary(data.get(), size);
+    BLAZE_TIMER_END();
+
+    if (!expected || !actual) {
+        log::error("Error: failed to parse {}: {}", name, actual ? "cocos returned null" : actual.unwrapErr());
+        if (expected) expected->release();
+        if (actual) actual.unwrap()->release();
+        return;
+    }
+
+    if (sameDict(expected, actual.unwrap())) {
+        log::info("Plist dictionary parser matches cocos ({}, {} root keys)", name, expected->count());
+    } else {
+        log::error("Plist dictionary parser mismatch ({})", name);
+    }
+
+    expected->release();
+    actual.unwrap()->release();
+}
+
+static void benchSpriteFrameLookup() {
+    constexpr size_t SPRITE_COUNT = 100'000;
+
+    auto cache = CCSpriteFrameCache::get();
+
+    std::vector<gd::string> names;
+    CCDictElement* elem;
+    CCDICT_FOREACH(cache->m_pSpriteFrames, elem) {
+        names.emplace_back(elem->getStrKey());
+    }
+
+    if (names.empty()) {
+        log::error("Error: no sprite frames loaded");
+        return;
+    }
+
+    for (auto& name : names) {
+        if (cache->spriteFrameByName(name.c_str()) != cache->m_pSpriteFrames->objectForKey(name)) {
+            log::error("Sprite frame lookup mismatch for {}", name);
+            return;
+        }
+    }
+
+    size_t found = 0;
+
+    BLAZE_TIMER_START("Look up 100k sprite frames (dictionary)");
+
+    for (size_t i = 0; i < SPRITE_COUNT; i++) {
+        found += cache->m_pSpriteFrames->objectForKey(names[i % names.size()]) != nullptr;
+    }
+
+    BLAZE_TIMER_STEP("Look up 100k sprite frames (spriteFrameByName)");
+
+    for (size_t i = 0; i < SPRITE_COUNT; i++) {
+        found += cache->spriteFrameByName(names[i % names.size()].c_str()) != nullptr;
+    }
+
+    BLAZE_TIMER_STEP("Create 100k sprites by frame name");
+
+    for (size_t i = 0; i < SPRITE_COUNT; i++) {
+        found += CCSprite::createWithSpriteFrameName(names[i % names.size()].c_str()) != nullptr;
+    }
+
+    BLAZE_TIMER_END();
+
+    log::info("Sprite frame lookups match the dictionary ({} frames, {} lookups hit)", names.size(), found);
+}
+
+// Straight port of CCNS.cpp from cocos2d-x 2.2, used as the reference for our parsers
+namespace vanilla {
+    using strArray = std::vector<std::string>;
+
+    static void split(const std::string& src, const char* token, strArray& vect) {
+        size_t nend = 0, nbegin = 0;
+        while (nend != std::string::npos) {
+            nend = src.find(token, nbegin);
+            if (nend == std::string::npos) {
+                vect.push_back(src.substr(nbegin, src.length() - nbegin));
+            } else {
+                vect.push_back(src.substr(nbegin, nend - nbegin));
+            }
+            nbegin = nend + strlen(token);
+        }
+    }
+
+    static bool splitWithForm(const char* pStr, strArray& strs) {
+        if (!pStr) return false;
+
+        std::string content = pStr;
+        if (content.empty()) return false;
+
+        size_t nPosLeft = content.find('{');
+        size_t nPosRight = content.find('}');
+
+        if (nPosLeft == std::string::npos || nPosRight == std::string::npos) return false;
+        if (nPosLeft > nPosRight) return false;
+
+        std::string pointStr = content.substr(nPosLeft + 1, nPosRight - nPosLeft - 1);
+        if (pointStr.empty()) return false;
+
+        if (pointStr.find('{') != std::string::npos || pointStr.find('}') != std::string::npos) return false;
+
+        split(pointStr, ",", strs);
+        if (strs.size() != 2 || strs[0].empty() || strs[1].empty()) {
+            strs.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    static CCPoint pointFromString(const char* str) {
+        strArray strs;
+        if (!splitWithForm(str, strs)) return CCPoint{0.f, 0.f};
+
+        return CCPoint{(float) atof(strs[0].c_str()), (float) atof(strs[1].c_str())};
+    }
+
+    static CCRect rectFromString(const char* str) {
+        if (!str) return CCRect{0.f, 0.f, 0.f, 0.f};
+
+        std::string content = str;
+
+        // find the first '{' and the third '}'
+        size_t nPosLeft = content.find('{');
+        size_t nPosRight = content.find('}');
+        for (int i = 1; i < 3; ++i) {
+            if (nPosRight == std::string::npos) break;
+            nPosRight = content.find('}', nPosRight + 1);
+        }
+
+        if (nPosLeft == std::string::npos || nPosRight == std::string::npos) return CCRect{0.f, 0.f, 0.f, 0.f};
+
+        content = content.substr(nPosLeft + 1, nPosRight - nPosLeft - 1);
+        size_t nPointEnd = content.find('}');
+        if (nPointEnd == std::string::npos) return CCRect{0.f, 0.f, 0.f, 0.f};
+        nPointEnd = content.find(',', nPointEnd);
+        if (nPointEnd == std::string::npos) return CCRect{0.f, 0.f, 0.f, 0.f};
+
+        std::string pointStr = content.substr(0, nPointEnd);
+        std::string sizeStr = content.substr(nPointEnd + 1, content.length() - nPointEnd);
+
+        strArray pointInfo, sizeInfo;
+        if (!splitWithForm(pointStr.c_str(), pointInfo)) return CCRect{0.f, 0.f, 0.f, 0.f};
+        if (!splitWithForm(sizeStr.c_str(), sizeInfo)) return CCRect{0.f, 0.f, 0.f, 0.f};
+
+        return CCRect{
+            (float) atof(pointInfo[0].c_str()),
+            (float) atof(pointInfo[1].c_str()),
+            (float) atof(sizeInfo[0].c_str()),
+            (float) atof(sizeInfo[1].c_str())
+        };
+    }
+}
+
+static bool sameBits(float a, float b) {
+    return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b);
+}
+
+static bool samePoint(const CCPoint& a, const CCPoint& b) {
+    return sameBits(a.x, b.x) && sameBits(a.y, b.y);
+}
+
+static bool sameRect(const CCRect& a, const CCRect& b) {
+    return samePoint(a.origin, b.origin) && sameBits(a.size.width, b.size.width) && sameBits(a.size.height, b.size.height);
+}
+
+// Random strings made of the characters that matter to the parsers, plus mutations of well formed ones
+static std::string fuzzGeometryString(std::mt19937& rng) {
+    static constexpr std::string_view alphabet = "{{{}}},,,0123456789..--+eE xna";
+
+    auto number = [&] {
+        std::uniform_real_distribution<double> dist(-1e4, 1e4);
+        return fmt::format("{}", dist(rng));
+    };
+
+    std::string out;
+
+    switch (rng() % 3) {
+        case 0: {
+            size_t len = rng() % 24;
+            for (size_t i = 0; i < len; i++) {
+                out += alphabet[rng() % alphabet.size()];
+            }
+        } break;
+
+        case 1: {
+            out = fmt::format("{{{},{}}}", number(), number());
+        } break;
+
+        case 2: {
+            out = fmt::format("{{{{{},{}}},{{{},{}}}}}", number(), number(), number(), number());
+        } break;
+    }
+
+    // mutate a few characters
+    size_t mutations = rng() % 3;
+    for (size_t i = 0; i < mutations && !out.empty(); i++) {
+        size_t pos = rng() % out.size();
+
+        switch (rng() % 3) {
+            case 0: out[pos] = alphabet[rng() % alphabet.size()]; break;
+            case 1: out.insert(out.begin() + pos, alphabet[rng() % alphabet.size()]); break;
+            case 2: out.erase(out.begin() + pos); break;
+        }
+    }
+
+    return out;
+}
+
+static void testGeometryParsers() {
+    std::vector<std::string> inputs = {
+        "", "{", "}", "{}", "{,}", "{1,}", "{,1}", "{1,2}", "{1,2,3}", "{1.5,-2.25}", " {1,2}", "{ 1,2}", "{1 ,2}",
+        "{1,2 }", "x{1,2}y", "{+1,2}", "{0x10,2}", "{inf,nan}", "{-nan,1}", "{nan(123),1}", "{1e999,-1e999}",
+        "{1e-50,1e-320}", "{.5,5.}", "{1e,2}", "{1,2", "}1,2{", "{{1,2}", "{1,{2}", "{1,2}}", "{0.1000000000000000055511151231257827,3.4028235677973366e38}",
+        "{{0,0},{0,0}}", "{{1,2},{3,4}}", "{{1,2},{3,45}", "{{1,2},{3,4}", "{{1,2},{3,4}}x", "{{1,2}x,{3,4}}", "{{1,2}},{3,4}}",
+        "{{1,2},{3,4},{5,6}}", "{{1,2,3},{4,5}}", "{{1,2}{3,4}}", "{{1,2},{3,4}x}", "{{-1.5,2e3},{.25,-0}}", "{{},{}}", "{{1,2},}",
+    };
+
+    std::mt19937 rng{1337};
+    for (size_t i = 0; i < 200'000; i++) {
+        inputs.push_back(fuzzGeometryString(rng));
+    }
+
+    size_t accepted = 0, failed = 0;
+
+    for (auto& input : inputs) {
+        auto expectedPoint = vanilla::pointFromString(input.c_str());
+        auto expectedRect = vanilla::rectFromString(input.c_str());
+
+        // whatever our parsers accept must match cocos exactly, the rest is left to cocos anyway
+        if (auto point = blaze::parseCCPoint(input)) {
+            accepted++;
+            if (!samePoint(*point, expectedPoint)) {
+                log::error("Point parser mismatch for '{}': {},{} vs {},{}", input, point->x, point->y, expectedPoint.x, expectedPoint.y);
+                failed++;
+            }
+        }
+
+        if (auto rect = blaze::parseCCRect(input)) {
+            accepted++;
+            if (!sameRect(*rect, expectedRect)) {
+                log::error("Rect parser mismatch for '{}'", input);
+                failed++;
+            }
+        }
+
+        // and the hooked cocos functions must match for everything
+        if (!samePoint(CCPointFromString(input.c_str()), expectedPoint) || !sameRect(CCRectFromString(input.c_str()), expectedRect)) {
+            log::error("Hooked parser mismatch for '{}'", input);
+            failed++;
+        }
+    }
+
+    if (failed) {
+        log::error("Geometry parsers: {} mismatches in {} inputs", failed, inputs.size());
+    } else {
+        log::info("Geometry parsers match cocos ({} inputs, {} accepted by the fast path)", inputs.size(), accepted);
+    }
+
+    std::vector<std::string> rects;
+    for (size_t i = 0; i < 100'000; i++) {
+        rects.push_back(fmt::format("{{{{{},{}}},{{{},{}}}}}", rng() % 4096, rng() % 4096, rng() % 512, rng() % 512));
+    }
+
+    float sink = 0.f;
+
+    BLAZE_TIMER_START("Parse 100k rects (cocos)");
+
+    for (auto& rect : rects) {
+        sink += vanilla::rectFromString(rect.c_str()).size.width;
+    }
+
+    BLAZE_TIMER_STEP("Parse 100k rects (hooked)");
+
+    for (auto& rect : rects) {
+        sink += CCRectFromString(rect.c_str()).size.width;
+    }
+
+    BLAZE_TIMER_END();
+
+    log::debug("(checksum {})", sink);
+}
+
+// Checks that frames in slabs are dropped by removeUnusedSpriteFrames, and destroyed once nothing else uses them
+static void testSpriteFrameSlabs() {
+    auto texture = CCTextureCache::get()->addImage("GJ_button_01.png", false);
+    unsigned int textureRefs = texture->retainCount();
+    CCRect rect{0.f, 0.f, 8.f, 8.f};
+
+    auto slab = std::make_unique<blaze::SpriteFrameSlab>(3);
+    for (size_t i = 0; i < 3; i++) {
+        slab->emplace(texture, rect, false, CCPointZero, rect.size);
+    }
+
+    Ref<CCDictionary> frames = CCDictionary::create();
+    frames->setObject(slab->at(0), "slab-unused-1");
+    frames->setObject(slab->at(1), "slab-unused-2");
+    frames->setObject(slab->at(2), "slab-used");
+    Ref<CCSpriteFrame> used = slab->at(2);
+    blaze::registerSpriteFrameSlab(std::move(slab));
+
+    auto vanilla = new CCSpriteFrame();
+    vanilla->initWithTexture(texture, rect);
+    frames->setObject(vanilla, "vanilla-unused");
+    vanilla->release();
+
+    size_t removed = blaze::removeUnusedSpriteFrames(frames);
+    blaze::sweepSpriteFrameSlabs();
+    unsigned int afterRemove = texture->retainCount();
+
+    used = nullptr;
+    frames->removeAllObjects();
+    blaze::sweepSpriteFrameSlabs();
+    unsigned int afterSweep = texture->retainCount();
+
+    if (removed != 3 || afterRemove != textureRefs + 1 || afterSweep != textureRefs) {
+        log::error(
+            "Sprite frame slabs: removed {} of 3 unused frames, texture refs {} -> {} -> {}",
+            removed, textureRefs, afterRemove, afterSweep
+        );
+    } else {
+        log::info("Sprite frame slabs: unused frames are removed and destroyed");
+    }
+}
+
+static void testRotatePositions() {
+    std::mt19937 rng{4242};
+    std::uniform_real_distribution<double> posDist(-1000.0, 100'000.0);
+    std::uniform_real_distribution<double> offsetDist(-50.0, 50.0);
+    std::uniform_real_distribution<float> angleDist(-360.f, 360.f);
+
+    size_t failed = 0, total = 0;
+    std::vector<double> x, y, ox, oy, ex, ey;
+
+    for (size_t round = 0; round < 2000; round++) {
+        // odd sizes too, to cover the scalar tail
+        size_t count = rng() % 67;
+        x.resize(count); y.resize(count); ox.resize(count); oy.resize(count);
+
+        for (size_t i = 0; i < count; i++) {
+            x[i] = posDist(rng);
+            y[i] = posDist(rng) / 20.0;
+            ox[i] = rng() % 3 ? 0.0 : offsetDist(rng);
+            oy[i] = rng() % 3 ? 0.0 : offsetDist(rng);
+        }
+
+        float angle = CC_DEGREES_TO_RADIANS(angleDist(rng));
+        auto transform = CCAffineTransformMake(
+            cosf(angle), -sinf(angle), sinf(angle), cosf(angle),
+            (float) posDist(rng), (float) (posDist(rng) / 20.0)
+        );
+        CCPoint center{(float) posDist(rng), (float) (posDist(rng) / 20.0)};
+        CCPoint claimed{(float) offsetDist(rng), (float) offsetDist(rng)};
+
+        // the same math as the game's rotation code
+        ex = x; ey = y;
+        for (size_t i = 0; i < count; i++) {
+            float xo = ox[i];
+            float yo = oy[i];
+            float v32 = ex[i] - xo - center.x;
+            float v33 = ey[i] - yo - center.y;
+            auto tresult = __CCPointApplyAffineTransform({v32, v33}, transform);
+            ex[i] = ox[i] + tresult.x + claimed.x;
+            ey[i] = oy[i] + tresult.y + claimed.y;
+        }
+
+        blaze::rotatePositions(x.data(), y.data(), ox.data(), oy.data(), count, {
+            transform.a, transform.b, transform.c, transform.d, transform.tx, transform.ty,
+            center.x, center.y, claimed.x, claimed.y
+        });
+
+        for (size_t i = 0; i < count; i++) {
+            total++;
+            if (std::bit_cast<uint64_t>(x[i]) != std::bit_cast<uint64_t>(ex[i]) || std::bit_cast<uint64_t>(y[i]) != std::bit_cast<uint64_t>(ey[i])) {
+                failed++;
+            }
+        }
+    }
+
+    if (failed) {
+        log::error("Rotated positions: {} mismatches in {} positions", failed, total);
+    } else {
+        log::info("Rotated positions match the game's math ({} positions)", total);
+    }
+
+    // The rotation engine copies positions out of the objects, rotates them in batches and copies them back,
+    // which is only worth it if it beats doing the math object by object, like the game does.
+    constexpr size_t OBJECT_COUNT = 100'000;
+    constexpr size_t BATCH_SIZE = 256;
+
+    std::vector<Ref<GameObject>> objects;
+    for (size_t i = 0; i < OBJECT_COUNT; i++) {
+        auto obj = GameObject::createWithKey(1);
+        obj->m_positionX = posDist(rng);
+        obj->m_positionY = posDist(rng) / 20.0;
+        objects.push_back(obj);
+    }
+
+    auto transform = CCAffineTransformMake(cosf(0.3f), -sinf(0.3f), sinf(0.3f), cosf(0.3f), 150.f, 40.f);
+    CCPoint center{300.f, 120.f};
+    CCPoint claimed{1.5f, -0.5f};
+    blaze::RotationTransform rt{
+        transform.a, transform.b, transform.c, transform.d, transform.tx, transform.ty,
+        center.x, center.y, claimed.x, claimed.y
+    };
+
+    BLAZE_TIMER_START("Rotate 100k object positions (per object)");
+
+    for (auto& obj : objects) {
+        float xo = obj->m_positionXOffset;
+        float yo = obj->m_positionYOffset;
+        float v32 = obj->m_positionX - xo - center.x;
+        float v33 = obj->m_positionY - yo - center.y;
+        auto tresult = __CCPointApplyAffineTransform({v32, v33}, transform);
+        obj->m_positionX = obj->m_positionXOffset + tresult.x + claimed.x;
+        obj->m_positionY = obj->m_positionYOffset + tresult.y + claimed.y;
+    }
+
+    BLAZE_TIMER_STEP("Rotate 100k object positions (batched)");
+
+    x.resize(BATCH_SIZE); y.resize(BATCH_SIZE); ox.resize(BATCH_SIZE); oy.resize(BATCH_SIZE);
+
+    for (size_t begin = 0; begin < OBJECT_COUNT; begin += BATCH_SIZE) {
+        size_t count = std::min(BATCH_SIZE, OBJECT_COUNT - begin);
+
+        for (size_t i = 0; i < count; i++) {
+            auto& obj = objects[begin + i];
+            x[i] = obj->m_positionX;
+            y[i] = obj->m_positionY;
+            ox[i] = obj->m_positionXOffset;
+            oy[i] = obj->m_positionYOffset;
+        }
+
+        blaze::rotatePositions(x.data(), y.data(), ox.data(), oy.data(), count, rt);
+
+        for (size_t i = 0; i < count; i++) {
+            auto& obj = objects[begin + i];
+            obj->m_positionX = x[i];
+            obj->m_positionY = y[i];
+        }
+    }
+
+    BLAZE_TIMER_END();
+}
+
+static bool sameFloat(float a, float b) {
+    return sameBits(a, b) || (std::isnan(a) && std::isnan(b));
+}
+
+static bool sameBox(const blaze::OrientedBox& a, const blaze::OrientedBox& b) {
+    for (size_t c = 0; c < 4; c++) {
+        if (!sameFloat(a.cornerX[c], b.cornerX[c]) || !sameFloat(a.cornerY[c], b.cornerY[c])) return false;
+    }
+
+    for (size_t ax = 0; ax < 2; ax++) {
+        if (!sameFloat(a.axisX[ax], b.axisX[ax]) || !sameFloat(a.axisY[ax], b.axisY[ax]) || !sameFloat(a.origin[ax], b.origin[ax])) return false;
+    }
+
+    return true;
+}
+
+// Doesn't touch the game at all, only compares the batched oriented box code with the one box at a time reference
+static void testOrientedBoxes() {
+    std::mt19937 rng{9001};
+    std::uniform_real_distribution<float> posDist(-150.f, 150.f);
+    std::uniform_real_distribution<float> sizeDist(0.f, 120.f);
+    std::uniform_real_distribution<float> angleDist(-7.f, 7.f);
+
+    std::vector<float> cx, cy, w, h, angle;
+    std::vector<uint8_t> overlaps;
+    blaze::OrientedBoxBatch batch;
+
+    size_t boxMismatches = 0, overlapMismatches = 0, totalBoxes = 0, totalOverlaps = 0;
+
+    for (size_t round = 0; round < 5000; round++) {
+        // odd sizes too, to cover the scalar tail
+        size_t count = rng() % 71;
+        cx.resize(count); cy.resize(count); w.resize(count); h.resize(count); angle.resize(count);
+
+        for (size_t i = 0; i < count; i++) {
+            cx[i] = posDist(rng);
+            cy[i] = posDist(rng);
+            // some degenerate and unrotated boxes as well
+            w[i] = rng() % 16 ? sizeDist(rng) : 0.f;
+            h[i] = rng() % 16 ? sizeDist(rng) : 0.f;
+            angle[i] = rng() % 4 ? angleDist(rng) : 0.f;
+        }
+
+        blaze::computeOrientedBoxes(batch, cx.data(), cy.data(), w.data(), h.data(), angle.data(), count);
+
+        for (size_t i = 0; i < count; i++) {
+            totalBoxes++;
+            if (!sameBox(batch.at(i), blaze::computeOrientedBox(cx[i], cy[i], w[i], h[i], angle[i]))) {
+                boxMismatches++;
+            }
+        }
+
+        auto player = blaze::computeOrientedBox(posDist(rng) / 3.f, posDist(rng) / 3.f, 30.f, 30.f, angleDist(rng));
+        overlaps.resize(count);
+        blaze::overlapOrientedBoxes(player, batch, overlaps.data());
+
+        for (size_t i = 0; i < count; i++) {
+            totalOverlaps += overlaps[i];
+            if ((overlaps[i] != 0) != blaze::orientedBoxesOverlap(player, batch.at(i))) {
+                overlapMismatches++;
+            }
+        }
+    }
+
+    if (boxMismatches || overlapMismatches) {
+        log::error("Oriented boxes: {} box and {} overlap mismatches in {} boxes", boxMismatches, overlapMismatches, totalBoxes);
+    } else {
+        log::info("Oriented boxes match the reference ({} boxes, {} overlapping)", totalBoxes, totalOverlaps);
+    }
+
+    size_t count = 100'000;
+    cx.resize(count); cy.resize(count); w.resize(count); h.resize(count); angle.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        cx[i] = posDist(rng); cy[i] = posDist(rng); w[i] = sizeDist(rng); h[i] = sizeDist(rng); angle[i] = angleDist(rng);
+    }
+
+    auto player = blaze::computeOrientedBox(0.f, 0.f, 30.f, 30.f, 0.5f);
+    std::vector<blaze::OrientedBox> single(count);
+    size_t sink = 0;
+
+    BLAZE_TIMER_START("Compute 100k oriented boxes (one at a time)");
+
+    for (size_t i = 0; i < count; i++) {
+        single[i] = blaze::computeOrientedBox(cx[i], cy[i], w[i], h[i], angle[i]);
+    }
+
+    BLAZE_TIMER_STEP("Compute 100k oriented boxes (batched)");
+
+    blaze::computeOrientedBoxes(batch, cx.data(), cy.data(), w.data(), h.data(), angle.data(), count);
+
+    BLAZE_TIMER_STEP("Test 100k oriented boxes (one at a time)");
+
+    for (auto& box : single) {
+        sink += blaze::orientedBoxesOverlap(player, box);
+    }
+
+    BLAZE_TIMER_STEP("Test 100k oriented boxes (batched)");
+
+    overlaps.resize(count);
+    blaze::overlapOrientedBoxes(player, batch, overlaps.data());
+
+    BLAZE_TIMER_END();
+
+    for (auto o : overlaps) sink += o;
+    log::debug("(checksum {})", sink);
+}
+
+// Builds the same batch node twice and checks that updating it in parallel gives the same quads as the plain loop
+static void testBatchTransforms() {
+    constexpr size_t SPRITE_COUNT = 20'000;
+
+    auto texture = CCTextureCache::get()->addImage("GJ_button_01.png", false);
+
+    auto build = [&] {
+        std::mt19937 rng{1337};
+        std::uniform_real_distribution<float> posDist(-500.f, 500.f);
+        std::uniform_real_distribution<float> angleDist(-360.f, 360.f);
+        std::uniform_real_distribution<float> scaleDist(-2.f, 2.f);
+
+        auto node = CCSpriteBatchNode::createWithTexture(texture, SPRITE_COUNT);
+
+        for (size_t i = 0; i < SPRITE_COUNT; i++) {
+            auto sprite = CCSprite::createWithTexture(texture);
+            sprite->setPosition({posDist(rng), posDist(rng)});
+            sprite->setRotation(angleDist(rng));
+            sprite->setScaleX(scaleDist(rng));
+            sprite->setScaleY(scaleDist(rng));
+            sprite->setFlipX(rng() % 2);
+            sprite->setVisible(rng() % 8 != 0);
+            node->addChild(sprite);
+
+            // nested sprites depend on the transform of their parent
+            if (rng() % 4 == 0) {
+                auto child = CCSprite::createWithTexture(texture);
+                child->setPosition({posDist(rng), posDist(rng)});
+                child->setRotation(angleDist(rng));
+                child->setSkewX(angleDist(rng) / 8.f);
+                sprite->addChild(child);
+            }
+        }
+
+        return node;
+    };
+
+    Ref<CCSpriteBatchNode> serial = build();
+    Ref<CCSpriteBatchNode> parallel = build();
+
+    BLAZE_TIMER_START("Update 20k batched sprites (serial)");
+
+    blaze::updateBatchTransforms(serial, false);
+
+    BLAZE_TIMER_STEP("Update 20k batched sprites (parallel)");
+
+    blaze::updateBatchTransforms(parallel, true);
+
+    BLAZE_TIMER_END();
+
+    auto serialAtlas = serial->getTextureAtlas();
+    auto parallelAtlas = parallel->getTextureAtlas();
+    size_t quads = serialAtlas->getTotalQuads();
+
+    if (quads != parallelAtlas->getTotalQuads()) {
+        log::error("Batch transforms: quad count differs ({} vs {})", quads, parallelAtlas->getTotalQuads());
+        return;
+    }
+
+    if (serialAtlas->isDirty() != parallelAtlas->isDirty()) {
+        log::error("Batch transforms: dirty flag differs ({} vs {})", serialAtlas->isDirty(), parallelAtlas->isDirty());
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < quads; i++) {
+        if (std::memcmp(&serialAtlas->getQuads()[i], &parallelAtlas->getQuads()[i], sizeof(ccV3F_C4B_T2F_Quad)) != 0) {
+            mismatches++;
+        }
+    }
+
+    if (mismatches) {
+        log::error("Batch transforms: {} mismatches in {} quads", mismatches, quads);
+    } else {
+        log::info("Parallel batch transforms match the serial ones ({} quads)", quads);
+    }
+}
+
 static void bench() {
+    // must go first, the sprite frame benchmark purges the cache
+    benchSpriteFrameLookup();
     benchSpriteFrames();
+    benchPlistParsers();
+    benchPlistDictionary();
+    testGeometryParsers();
+    testSpriteFrameSlabs();
+    testRotatePositions();
+    testOrientedBoxes();
+    testBatchTransforms();
+
+    blaze::armTriggerReplayCheck();
 }
 
 class $modify(MenuLayer) {
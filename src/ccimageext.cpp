@@ -9,12 +9,15 @@
 #include <algo/crc32.hpp>
 #include <tracing.hpp>
 #include <settings.hpp>
+#include <profile.hpp>
 #include <fpff.hpp>
 
 #include <Geode/loader/Log.hpp>
 #include <Geode/Prelude.hpp>
+#include <asp/time/Instant.hpp>
 
 using namespace geode::prelude;
+using namespace asp::time;
 
 namespace blaze {
 
@@ -69,12 +72,19 @@ Result<> CCImageExt::initWithFPNG(const void* data, size_t size) {
 Result<> CCImageExt::initWithSPNGOrCache(const uint8_t* buffer, size_t size, const char* imgPath) {
     ZoneScoped;
 
-    // if image cache is disabled, or small mode is enabled and image is <64k, don't do caching
-    if (!blaze::settings().imageCache || (blaze::settings().imageCacheSmall && size < 65536)) {
-        return this->initWithSPNG(buffer, size);
-    }
+    auto& profile = blaze::LaunchProfile::get();
+    auto startTime = Instant::now();
+
+    // if image cache is disabled, or small mode is enabled and image is <64k, don't do caching.
+    // previous launches know better than the size heuristic whether the cache is worth it for this file.
+    bool useCache = blaze::settings().imageCache
+        && profile.cacheVerdict(imgPath).value_or(!(blaze::settings().imageCacheSmall && size < 65536));
 
-    blaze::ThreadSafeFileUtilsGuard _guard;
+    if (!useCache) {
+        auto result = this->initWithSPNG(buffer, size);
+        profile.record(imgPath, LaunchProfile::Stage::Decode, startTime.elapsed());
+        return result;
+    }
 
     // check if we have cached it already
     auto checksum = blaze::crc32(buffer, size);
@@ -86,13 +96,17 @@ Result<> CCImageExt::initWithSPNGOrCache(const uint8_t* buffer, size_t size, con
         std::vector<uint8_t> data(buffer, buffer + size);
 
         LoadManager::get().queueForCache(std::filesystem::path(blaze::fullPathForFilename(imgPath)), std::move(data));
-        return this->initWithSPNG(buffer, size);
+
+        auto result = this->initWithSPNG(buffer, size);
+        profile.record(imgPath, LaunchProfile::Stage::CacheMiss, startTime.elapsed());
+        return result;
     }
 
     auto result = this->initWithFPNG(cachedBuf, cachedSize);
     delete[] cachedBuf;
 
     if (result) {
+        profile.record(imgPath, LaunchProfile::Stage::CacheHit, startTime.elapsed());
         return Ok();
     }
 
@@ -1,23 +1,14 @@
 #include <Geode/modify/CCFileUtils.hpp>
-#include <asp/sync/SpinLock.hpp>
 #include <asp/time.hpp>
 #include "fpff.hpp"
 
 using namespace geode::prelude;
 
-static std::unordered_map<uint64_t, gd::string> g_cache;
-static asp::SpinLock<> g_lock;
-static std::atomic<bool> g_threadSafe{false};
-
 namespace blaze {
 
-ThreadSafeFileUtilsGuard::ThreadSafeFileUtilsGuard() {
-    m_previousState = g_threadSafe.exchange(true, std::memory_order::acq_rel);
-}
-
-ThreadSafeFileUtilsGuard::~ThreadSafeFileUtilsGuard() {
-    g_threadSafe.store(m_previousState, std::memory_order::release);
-}
+// interned input -> interned full path, separately for lookups with and without the quality suffix
+static IdMap<StringId> g_cache{INVALID_STRING_ID};
+static IdMap<StringId> g_cacheNoSuffix{INVALID_STRING_ID};
 
 struct HookedFileUtils : public Modify<HookedFileUtils, CCFileUtils> {
     static HookedFileUtils& get() {
@@ -37,15 +28,15 @@ struct HookedFileUtils : public Modify<HookedFileUtils, CCFileUtils> {
     $override
     void purgeCachedEntries() {
         CCFileUtils::purgeCachedEntries();
-        auto guard = g_lock.lock();
         g_cache.clear();
+        g_cacheNoSuffix.clear();
     }
 
     $override
     static void purgeFileUtils() {
         CCFileUtils::purgeFileUtils();
-        auto guard = g_lock.lock();
         g_cache.clear();
+        g_cacheNoSuffix.clear();
     }
 };
 
@@ -60,15 +51,6 @@ static TextureQuality getTextureQuality() {
     }
 }
 
-static uint64_t fnv1aHash(std::string_view s) {
-    uint64_t hash = 0xcbf29ce484222325;
-    for (char c : s) {
-        hash ^= static_cast<uint64_t>(c);
-        hash *= 0x100000001b3;
-    }
-    return hash;
-}
-
 template <size_t N>
 static void appendToBuf(std::array<char, N>& buf, size_t& offset, std::string_view str) {
     size_t toCopy = std::min(str.size(), N - offset - 1);
@@ -92,64 +74,46 @@ static std::string_view getQualitySuffix(TextureQuality quality) {
     }
 }
 
-void setFileUtilsThreadSafe(bool threadSafe) {
-    g_threadSafe.store(threadSafe, std::memory_order::release);
-}
+// A resolved path, either interned and cached, or (for absolute paths, misses, or once the interner is full) just the string.
+struct ResolvedPath {
+    StringId id = INVALID_STRING_ID;
+    gd::string path;
+};
 
-static void cachePath(uint64_t hash, const gd::string& path) {
-    if (g_threadSafe.load(std::memory_order::acquire)) {
-        auto guard = g_lock.lock();
-        g_cache.emplace(hash, path);
-    } else {
-        g_cache.emplace(hash, path);
-    }
+static bool isAbsolutePath(std::string_view input) {
+    // we try to make this check as cheap as possible, so don't rely on std::filesystem or cocos
+#ifdef GEODE_IS_WINDOWS
+    return (input.size() >= 3 && std::isalpha(input[0]) && input[1] == ':' && (input[2] == '/' || input[2] == '\\'))
+        || (input.size() >= 2 && input[0] == '\\' && input[1] == '\\');
+#else
+    return input.size() >= 1 && input[0] == '/';
+#endif
 }
 
-static gd::string getCachedPath(uint64_t hash) {
-    if (g_threadSafe.load(std::memory_order::acquire)) {
-        auto guard = g_lock.lock();
-        auto it = g_cache.find(hash);
-        if (it != g_cache.end()) {
-            return it->second;
-        }
-    } else {
-        auto it = g_cache.find(hash);
-        if (it != g_cache.end()) {
-            return it->second;
-        }
+static ResolvedPath cachePath(IdMap<StringId>& cache, std::string_view input, std::string_view path) {
+    StringId pathId = tryInternString(path);
+    StringId inputId = tryInternString(input);
+
+    if (pathId == INVALID_STRING_ID || inputId == INVALID_STRING_ID) {
+        return {INVALID_STRING_ID, gd::string{path.data(), path.size()}};
     }
 
-    return {};
+    cache.set(inputId, pathId);
+    return {pathId, {}};
 }
 
-gd::string fullPathForFilename(std::string_view input, bool ignoreSuffix) {
-    if (input.empty()) {
-        return {};
-    }
-
-    // if the input is an absolute path, return it as is
-    // we try to make this check as cheap as possible, so don't rely on std::filesystem or cocos
-#ifdef GEODE_IS_WINDOWS
-    if (input.size() >= 3 && std::isalpha(input[0]) && input[1] == ':' && (input[2] == '/' || input[2] == '\\')) {
-        return gd::string{input};
-    } else if (input.size() >= 2 && input[0] == '\\' && input[1] == '\\') {
-        return gd::string{input};
-    }
-#else
-    if (input.size() >= 1 && input[0] == '/') {
-        return gd::string{input.data(), input.size()};
+static ResolvedPath resolvePath(std::string_view input, bool ignoreSuffix) {
+    // absolute paths are returned as is, they are often one-off and are not worth interning
+    if (isAbsolutePath(input)) {
+        return {INVALID_STRING_ID, gd::string{input.data(), input.size()}};
     }
-#endif
 
     // try to find the string in cache
-    auto hash = fnv1aHash(input);
-    if (ignoreSuffix) {
-        hash ^= 0xdeadbeefdeadbeef;
-    }
+    auto& cache = ignoreSuffix ? g_cacheNoSuffix : g_cache;
 
-    auto cached = getCachedPath(hash);
-    if (!cached.empty()) {
-        return cached;
+    StringId cached = cache.get(findInternedString(input));
+    if (cached != INVALID_STRING_ID) {
+        return {cached, {}};
     }
 
     auto& fu = HookedFileUtils::get();
@@ -196,23 +160,53 @@ gd::string fullPathForFilename(std::string_view input, bool ignoreSuffix) {
     for (const auto& sp : searchPaths) {
         auto fp = blaze::getPathForFilename(filename, "", sp);
         if (!fp.empty()) {
-            cachePath(hash, fp);
-            return fp;
+            return cachePath(cache, input, std::string_view{fp.data(), fp.size()});
         }
     }
 
     if (ignoreSuffix) {
-        // if all else fails, accept defeat
-        cachePath(hash, gd::string{filename.data(), filename.size()});
-        return gd::string{filename.data(), filename.size()};
+        // if all else fails, accept defeat. misses are not cached, the file might show up later and they can be anything
+        return {INVALID_STRING_ID, gd::string{filename.data(), filename.size()}};
     } else {
         // try to find the file without the quality suffix
-        auto ret = fullPathForFilename(input, true);
-        cachePath(hash, ret);
+        auto ret = resolvePath(input, true);
+        if (ret.id != INVALID_STRING_ID) {
+            if (StringId inputId = tryInternString(input); inputId != INVALID_STRING_ID) {
+                cache.set(inputId, ret.id);
+            }
+        }
+
         return ret;
     }
 }
 
+gd::string fullPathForFilename(std::string_view input, bool ignoreSuffix) {
+    if (input.empty()) {
+        return {};
+    }
+
+    auto resolved = resolvePath(input, ignoreSuffix);
+    if (resolved.id != INVALID_STRING_ID) {
+        return gd::string{internedString(resolved.id)};
+    }
+
+    return std::move(resolved.path);
+}
+
+StringId fullPathIdForFilename(std::string_view input, bool ignoreSuffix) {
+    if (input.empty()) {
+        return INVALID_STRING_ID;
+    }
+
+    auto resolved = resolvePath(input, ignoreSuffix);
+    if (resolved.id != INVALID_STRING_ID) {
+        return resolved.id;
+    }
+
+    // the caller needs an id, but the path still doesn't go into the cache
+    return tryInternString(std::string_view{resolved.path.data(), resolved.path.size()});
+}
+
 
 static bool fileExists(const char* path) {
 #ifdef GEODE_IS_WINDOWS
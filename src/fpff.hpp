@@ -1,9 +1,9 @@
 #pragma once
 #include <Geode/Geode.hpp>
+#include <util/intern.hpp>
 
-// Faster rewrite of CCFileUtils::fullPathForFilename, optionally thread-safe
-// Thread safety can be enabled and disabled globally, by calling `blaze::setFileUtilsThreadSafe(bool)`
-// Or by constructing a `ThreadSafeFileUtilsGuard` object that will enable thread-safety for its lifetime
+// Faster rewrite of CCFileUtils::fullPathForFilename, thread-safe.
+// Resolved paths are cached in a lock-free table keyed by the interned input string.
 
 namespace blaze {
 
@@ -11,15 +11,8 @@ enum class TextureQuality {
     Low, Medium, High
 };
 
-void setFileUtilsThreadSafe(bool threadSafe);
-
-struct ThreadSafeFileUtilsGuard {
-    ThreadSafeFileUtilsGuard();
-    ~ThreadSafeFileUtilsGuard();
-
-private:
-    bool m_previousState;
-};
+// Same as `fullPathForFilename`, but returns the interned full path, which avoids copying the string.
+StringId fullPathIdForFilename(std::string_view input, bool ignoreSuffix = false);
 
 gd::string fullPathForFilename(std::string_view input, bool ignoreSuffix = false);
 gd::string getPathForFilename(std::string_view filename, std::string_view resolutionDir, std::string_view searchPath);
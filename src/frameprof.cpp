@@ -0,0 +1,451 @@
+#include "frameprof.hpp"
+
+#include <Geode/Geode.hpp>
+#include <Geode/modify/CCDirector.hpp>
+#include <Geode/modify/PlayLayer.hpp>
+#include <asp/sync/Mutex.hpp>
+#include <settings.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+using namespace geode::prelude;
+
+namespace blaze::frameprof {
+
+std::atomic_bool g_enabled = false;
+
+namespace {
+    // amount of frames that the percentiles, the histogram and the CSV cover
+    constexpr size_t WINDOW = 300;
+    constexpr size_t TOP_N = 12;
+    constexpr size_t REFRESH_INTERVAL = 20;
+
+    constexpr size_t HISTOGRAM_BUCKETS = 40;
+    constexpr float HISTOGRAM_BUCKET_MS = 1.f;
+    constexpr float HISTOGRAM_BAR_WIDTH = 6.f;
+
+    asp::Mutex<std::vector<std::unique_ptr<ThreadCounters>>> s_threads;
+    asp::Mutex<std::vector<const char*>> s_functions;
+    std::atomic_size_t s_functionCount = 0;
+    asp::Mutex<std::vector<geode::Hook*>> s_hooks;
+
+    // Per-frame times of the last WINDOW frames, indexed by `frames % WINDOW`
+    struct History {
+        std::vector<float> frameMs = std::vector<float>(WINDOW);
+        std::vector<float> functionMs = std::vector<float>(WINDOW * MAX_FUNCTIONS);
+        std::vector<float> functionCalls = std::vector<float>(WINDOW * MAX_FUNCTIONS);
+        uint64_t lastNanos[MAX_FUNCTIONS] = {};
+        uint64_t lastCalls[MAX_FUNCTIONS] = {};
+        uint64_t lastFrame = 0;
+        size_t frames = 0;
+
+        size_t size() const {
+            return std::min(frames, WINDOW);
+        }
+
+        // Index of the i-th frame in the window, oldest first
+        size_t slot(size_t i) const {
+            return (frames - this->size() + i) % WINDOW;
+        }
+    };
+
+    std::unique_ptr<History> s_history;
+
+    struct FunctionStats {
+        const char* name;
+        float avgMs, p50Ms, p99Ms, calls;
+    };
+
+    float percentile(std::vector<float>& values, float p) {
+        if (values.empty()) return 0.f;
+
+        size_t idx = std::min(values.size() - 1, (size_t)(p * (values.size() - 1)));
+        std::nth_element(values.begin(), values.begin() + idx, values.end());
+        return values[idx];
+    }
+
+    class FrameProfilerOverlay : public CCNode {
+    public:
+        static FrameProfilerOverlay* create() {
+            auto ret = new FrameProfilerOverlay();
+            if (ret->init()) {
+                ret->autorelease();
+                return ret;
+            }
+
+            delete ret;
+            return nullptr;
+        }
+
+        bool init() override {
+            if (!CCNode::init()) return false;
+
+            this->setZOrder(10000);
+            this->setID("frame-profiler"_spr);
+
+            m_background = CCLayerColor::create({0, 0, 0, 160});
+            m_background->ignoreAnchorPointForPosition(false);
+            m_background->setAnchorPoint({0.f, 1.f});
+            this->addChild(m_background);
+
+            m_header = this->makeLabel({0.f, 1.f}, kCCTextAlignmentLeft);
+
+            // avg, p50, p99, calls are right aligned, the name is left aligned
+            float columnX[] = {40.f, 80.f, 120.f, 155.f, 162.f};
+            for (size_t i = 0; i < 5; i++) {
+                m_columns[i] = this->makeLabel({i == 4 ? 0.f : 1.f, 1.f}, i == 4 ? kCCTextAlignmentLeft : kCCTextAlignmentRight);
+                m_columns[i]->setPositionX(columnX[i]);
+            }
+
+            m_histogram = CCDrawNode::create();
+            this->addChild(m_histogram);
+
+            return true;
+        }
+
+        void refresh(const std::vector<FunctionStats>& top, std::vector<float>& frameTimes) {
+            auto winSize = CCDirector::get()->getWinSize();
+            this->setPosition({4.f, winSize.height - 4.f});
+
+            float p50 = percentile(frameTimes, 0.5f);
+            float p99 = percentile(frameTimes, 0.99f);
+
+            m_header->setString(fmt::format(
+                "frame p50 {:.2f}ms  p99 {:.2f}ms  ({} frames)", p50, p99, frameTimes.size()
+            ).c_str());
+
+            std::string columns[5] = {"avg", "p50", "p99", "calls", "function"};
+            for (auto& fn : top) {
+                columns[0] += fmt::format("\n{:.3f}", fn.avgMs);
+                columns[1] += fmt::format("\n{:.3f}", fn.p50Ms);
+                columns[2] += fmt::format("\n{:.3f}", fn.p99Ms);
+                columns[3] += fmt::format("\n{:.0f}", fn.calls);
+                columns[4] += fmt::format("\n{}", fn.name);
+            }
+
+            float tableTop = -m_header->getScaledContentSize().height - 2.f;
+            float tableHeight = 0.f;
+
+            for (size_t i = 0; i < 5; i++) {
+                m_columns[i]->setString(columns[i].c_str());
+                m_columns[i]->setPositionY(tableTop);
+                tableHeight = std::max(tableHeight, m_columns[i]->getScaledContentSize().height);
+            }
+
+            float histogramBottom = tableTop - tableHeight - 36.f;
+            this->drawHistogram(frameTimes, histogramBottom, p50, p99);
+
+            float width = std::max(
+                HISTOGRAM_BUCKETS * HISTOGRAM_BAR_WIDTH,
+                m_columns[4]->getPositionX() + m_columns[4]->getScaledContentSize().width
+            ) + 4.f;
+
+            m_background->setContentSize({width, -histogramBottom + 4.f});
+            m_background->setPosition({-2.f, 2.f});
+        }
+
+    private:
+        CCLayerColor* m_background = nullptr;
+        CCLabelBMFont* m_header = nullptr;
+        CCLabelBMFont* m_columns[5] = {};
+        CCDrawNode* m_histogram = nullptr;
+
+        CCLabelBMFont* makeLabel(CCPoint anchor, CCTextAlignment alignment) {
+            auto label = CCLabelBMFont::create("", "chatFont.fnt");
+            label->setScale(0.5f);
+            label->setAnchorPoint(anchor);
+            label->setAlignment(alignment);
+            this->addChild(label);
+            return label;
+        }
+
+        // One bar per millisecond of frame time, with lines at the median and the 99th percentile
+        void drawHistogram(const std::vector<float>& frameTimes, float bottom, float p50, float p99) {
+            constexpr float barWidth = HISTOGRAM_BAR_WIDTH;
+            constexpr float maxHeight = 30.f;
+
+            size_t buckets[HISTOGRAM_BUCKETS] = {};
+            size_t highest = 1;
+
+            for (float ms : frameTimes) {
+                size_t b = std::min(HISTOGRAM_BUCKETS - 1, (size_t)(ms / HISTOGRAM_BUCKET_MS));
+                highest = std::max(highest, ++buckets[b]);
+            }
+
+            m_histogram->clear();
+
+            ccColor4F barColor{0.4f, 0.8f, 1.f, 0.9f};
+            for (size_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                if (!buckets[b]) continue;
+
+                float x = b * barWidth;
+                float h = std::max(1.f, maxHeight * buckets[b] / highest);
+                CCPoint verts[4] = {{x, bottom}, {x + barWidth - 1.f, bottom}, {x + barWidth - 1.f, bottom + h}, {x, bottom + h}};
+                m_histogram->drawPolygon(verts, 4, barColor, 0.f, barColor);
+            }
+
+            auto marker = [&](float ms, ccColor4F color) {
+                float x = std::min(ms / HISTOGRAM_BUCKET_MS, (float)HISTOGRAM_BUCKETS) * barWidth;
+                m_histogram->drawSegment({x, bottom}, {x, bottom + maxHeight}, 0.5f, color);
+            };
+
+            marker(p50, {0.3f, 1.f, 0.3f, 1.f});
+            marker(p99, {1.f, 0.3f, 0.3f, 1.f});
+        }
+    };
+
+    FrameProfilerOverlay* s_overlay = nullptr;
+
+    std::vector<const char*> functionNames() {
+        return *s_functions.lock();
+    }
+
+    std::vector<FunctionStats> topFunctions(const History& history) {
+        auto names = functionNames();
+        size_t frames = history.size();
+
+        std::vector<FunctionStats> stats;
+        std::vector<float> times(frames);
+
+        for (size_t f = 0; f < names.size(); f++) {
+            float total = 0.f, calls = 0.f;
+
+            for (size_t i = 0; i < frames; i++) {
+                size_t slot = history.slot(i);
+                times[i] = history.functionMs[slot * MAX_FUNCTIONS + f];
+                calls += history.functionCalls[slot * MAX_FUNCTIONS + f];
+                total += times[i];
+            }
+
+            if (total <= 0.f) continue;
+
+            stats.push_back(FunctionStats {
+                .name = names[f],
+                .avgMs = total / frames,
+                .p50Ms = percentile(times, 0.5f),
+                .p99Ms = percentile(times, 0.99f),
+                .calls = calls / frames,
+            });
+        }
+
+        std::sort(stats.begin(), stats.end(), [](auto& a, auto& b) { return a.avgMs > b.avgMs; });
+        if (stats.size() > TOP_N) {
+            stats.resize(TOP_N);
+        }
+
+        return stats;
+    }
+
+    void refreshOverlay(const History& history) {
+        if (!s_overlay) {
+            s_overlay = FrameProfilerOverlay::create();
+            s_overlay->retain();
+            SceneManager::get()->keepAcrossScenes(s_overlay);
+        }
+
+        std::vector<float> frameTimes;
+        for (size_t i = 0; i < history.size(); i++) {
+            frameTimes.push_back(history.frameMs[history.slot(i)]);
+        }
+
+        s_overlay->refresh(topFunctions(history), frameTimes);
+    }
+
+    void removeOverlay() {
+        if (!s_overlay) return;
+
+        SceneManager::get()->forget(s_overlay);
+        s_overlay->removeFromParent();
+        s_overlay->release();
+        s_overlay = nullptr;
+    }
+
+    void sumCounters(uint64_t* nanos, uint64_t* calls, size_t count) {
+        std::fill_n(nanos, count, 0);
+        std::fill_n(calls, count, 0);
+
+        auto threads = s_threads.lock();
+        for (auto& thread : *threads) {
+            for (size_t f = 0; f < count; f++) {
+                nanos[f] += thread->nanos[f].load(std::memory_order::relaxed);
+                calls[f] += thread->calls[f].load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    void onFrame() {
+        if (!s_history) {
+            s_history = std::make_unique<History>();
+        }
+
+        auto& history = *s_history;
+        uint64_t time = now();
+        size_t count = s_functionCount.load(std::memory_order::acquire);
+
+        uint64_t nanos[MAX_FUNCTIONS], calls[MAX_FUNCTIONS];
+        sumCounters(nanos, calls, count);
+
+        // the first frame only sets the baseline, the counters keep going while the profiler is off
+        if (history.lastFrame != 0) {
+            size_t slot = history.frames % WINDOW;
+            history.frameMs[slot] = (time - history.lastFrame) / 1'000'000.f;
+
+            for (size_t f = 0; f < MAX_FUNCTIONS; f++) {
+                bool known = f < count;
+                history.functionMs[slot * MAX_FUNCTIONS + f] = known ? (nanos[f] - history.lastNanos[f]) / 1'000'000.f : 0.f;
+                history.functionCalls[slot * MAX_FUNCTIONS + f] = known ? (float)(calls[f] - history.lastCalls[f]) : 0.f;
+            }
+
+            history.frames++;
+        }
+
+        std::copy_n(nanos, count, history.lastNanos);
+        std::copy_n(calls, count, history.lastCalls);
+        history.lastFrame = time;
+
+        if (history.frames != 0 && history.frames % REFRESH_INTERVAL == 0) {
+            refreshOverlay(history);
+        }
+    }
+
+    void dumpCsv() {
+        if (!s_history || s_history->frames == 0) return;
+
+        auto& history = *s_history;
+        auto names = functionNames();
+        auto path = Mod::get()->getSaveDir() / "frame-profile.csv";
+
+        std::ofstream out(path);
+        if (!out) {
+            log::warn("Failed to open {} for writing", path);
+            return;
+        }
+
+        out << "frame,frame_ms";
+        for (auto name : names) {
+            out << ",\"" << name << " ms\"";
+        }
+        for (auto name : names) {
+            out << ",\"" << name << " calls\"";
+        }
+        out << '\n';
+
+        for (size_t i = 0; i < history.size(); i++) {
+            size_t slot = history.slot(i);
+            out << (history.frames - history.size() + i) << ',' << history.frameMs[slot];
+
+            for (size_t f = 0; f < names.size(); f++) {
+                out << ',' << history.functionMs[slot * MAX_FUNCTIONS + f];
+            }
+            for (size_t f = 0; f < names.size(); f++) {
+                out << ',' << history.functionCalls[slot * MAX_FUNCTIONS + f];
+            }
+            out << '\n';
+        }
+
+        log::info("Frame profile ({} frames) saved to {}", history.size(), path);
+    }
+
+    void setEnabled(bool enabled) {
+        if (g_enabled.exchange(enabled) == enabled) return;
+
+        for (auto hook : *s_hooks.lock()) {
+            auto res = enabled ? hook->enable() : hook->disable();
+            if (!res) {
+                log::warn("Failed to toggle a frame profiler hook: {}", res.unwrapErr());
+            }
+        }
+
+        if (!enabled) {
+            dumpCsv();
+            removeOverlay();
+            s_history.reset();
+        }
+    }
+}
+
+ThreadCounters& registerThread() {
+    auto counters = std::make_unique<ThreadCounters>();
+    t_counters = counters.get();
+
+    // never freed, so late scopes on exiting threads are harmless
+    s_threads.lock()->push_back(std::move(counters));
+
+    return *t_counters;
+}
+
+uint16_t registerFunction(const char* name) {
+    auto functions = s_functions.lock();
+
+    for (size_t i = 0; i < functions->size(); i++) {
+        if (std::strcmp((*functions)[i], name) == 0) {
+            return i;
+        }
+    }
+
+    // everything past the limit is lumped together
+    if (functions->size() == MAX_FUNCTIONS - 1) {
+        functions->push_back("(other)");
+        s_functionCount.store(functions->size(), std::memory_order::release);
+    }
+
+    if (functions->size() == MAX_FUNCTIONS) {
+        return MAX_FUNCTIONS - 1;
+    }
+
+    functions->push_back(name);
+    s_functionCount.store(functions->size(), std::memory_order::release);
+
+    return functions->size() - 1;
+}
+
+void registerHook(geode::Hook* hook) {
+    if (!blaze::settings().frameProfiler) {
+        hook->setAutoEnable(false);
+    }
+
+    s_hooks.lock()->push_back(hook);
+}
+
+struct FrameProfilerCCDirector : Modify<FrameProfilerCCDirector, CCDirector> {
+    static void onModify(auto& self) {
+        for (auto& [name, hook] : self.m_hooks) {
+            registerHook(hook.get());
+        }
+    }
+
+    $override
+    void drawScene() {
+        CCDirector::drawScene();
+
+        if (g_enabled.load(std::memory_order::relaxed)) {
+            onFrame();
+        }
+    }
+};
+
+struct FrameProfilerPlayLayer : Modify<FrameProfilerPlayLayer, PlayLayer> {
+    $override
+    void onQuit() {
+        if (g_enabled.load(std::memory_order::relaxed)) {
+            dumpCsv();
+        }
+
+        PlayLayer::onQuit();
+    }
+};
+
+}
+
+$execute {
+    blaze::frameprof::g_enabled = blaze::settings().frameProfiler;
+
+    listenForSettingChanges<bool>("frame-profiler", +[](bool value) {
+        blaze::settings().frameProfiler = value;
+        blaze::frameprof::setEnabled(value);
+    });
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace geode {
+    class Hook;
+}
+
+// In-game frame profiler, backs the `PROFILER_HOOK`s in tracing.cpp while the "frame-profiler" setting is on.
+//
+// Every hooked function gets a slot in a table of counters (time spent and calls) owned by each thread, which only that
+// thread writes to. Once per frame the main thread sums the tables up and keeps the per-frame times of the last few seconds.
+// The overlay shows the functions that take the most time per frame along with their median and 99th percentile,
+// and a histogram of whole frame times. The same data is written to `frame-profile.csv` in the mod save dir
+// when leaving a level or turning the profiler off.
+//
+// Time is inclusive, so a function that calls another hooked function is charged for both. Recursive calls are only timed
+// at the outermost level. Time spent on other threads is added up too, so the sum can be above the frame time.
+
+namespace blaze::frameprof {
+    constexpr size_t MAX_FUNCTIONS = 256;
+
+    extern std::atomic_bool g_enabled;
+
+    struct ThreadCounters {
+        std::atomic<uint64_t> nanos[MAX_FUNCTIONS] = {};
+        std::atomic<uint64_t> calls[MAX_FUNCTIONS] = {};
+        uint16_t depth[MAX_FUNCTIONS] = {};
+    };
+
+    inline thread_local ThreadCounters* t_counters = nullptr;
+
+    // Creates the counters of the current thread.
+    ThreadCounters& registerThread();
+
+    // Returns the slot of the function with this name (a string literal), registering it on the first call.
+    uint16_t registerFunction(const char* name);
+
+    // Hooks given here are only enabled while the profiler is on.
+    void registerHook(geode::Hook* hook);
+
+    inline uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    struct Scope {
+        ThreadCounters* counters = nullptr;
+        uint64_t start = 0;
+        uint16_t slot;
+
+        inline Scope(uint16_t slot) : slot(slot) {
+            if (!g_enabled.load(std::memory_order::relaxed)) return;
+
+            counters = t_counters ? t_counters : &registerThread();
+            if (counters->depth[slot]++ == 0) {
+                start = now();
+            }
+        }
+
+        // only the owning thread writes to the counters, so there's no need for atomic increments
+        inline ~Scope() {
+            if (!counters) return;
+
+            if (--counters->depth[slot] == 0) {
+                auto& nanos = counters->nanos[slot];
+                nanos.store(nanos.load(std::memory_order::relaxed) + (now() - start), std::memory_order::relaxed);
+            }
+
+            auto& calls = counters->calls[slot];
+            calls.store(calls.load(std::memory_order::relaxed) + 1, std::memory_order::relaxed);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+}
+
+#define BLAZE_FRAME_SCOPE(name) \
+    static const uint16_t _blazeFrameSlot = ::blaze::frameprof::registerFunction(name); \
+    ::blaze::frameprof::Scope _blazeFrameScope{_blazeFrameSlot}
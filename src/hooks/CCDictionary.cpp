@@ -0,0 +1,56 @@
+#include <Geode/Geode.hpp>
+#include <Geode/modify/CCDictionary.hpp>
+
+#include <fpff.hpp>
+#include <manager.hpp>
+#include <tracing.hpp>
+
+#include "load/plist.hpp"
+
+// Routes plist loading through our plist parser instead of cocos' SAX parser, which builds a std::string for every
+// element name and piece of text. GD loads its level data, sound effect lists, achievements and everything else this way.
+// Anything our parser doesn't accept is handed to the original, so the resulting dictionaries are always identical.
+
+using namespace geode::prelude;
+
+struct CCDictionaryHook : Modify<CCDictionaryHook, CCDictionary> {
+    $override
+    static CCDictionary* createWithContentsOfFileThreadSafe(const char* pFileName) {
+        ZoneScoped;
+
+        if (!pFileName) {
+            return CCDictionary::createWithContentsOfFileThreadSafe(pFileName);
+        }
+
+        blaze::StringId pathId = blaze::fullPathIdForFilename(pFileName);
+        if (pathId == blaze::INVALID_STRING_ID) {
+            return CCDictionary::createWithContentsOfFileThreadSafe(pFileName);
+        }
+
+        size_t size = 0;
+        auto data = LoadManager::get().readFile(blaze::internedString(pathId), size, true);
+        if (!data || size == 0) {
+            return CCDictionary::createWithContentsOfFileThreadSafe(pFileName);
+        }
+
+        auto res = blaze::parsePlistDictionary(data.get(), size);
+        if (!res) {
+#ifdef BLAZE_DEBUG
+            log::warn("Falling back to cocos for plist {}: {}", pFileName, res.unwrapErr());
+#endif
+            return CCDictionary::createWithContentsOfFileThreadSafe(pFileName);
+        }
+
+        return res.unwrap();
+    }
+
+    $override
+    static CCDictionary* createWithContentsOfFile(const char* pFileName) {
+        auto dict = createWithContentsOfFileThreadSafe(pFileName);
+        if (dict) {
+            dict->autorelease();
+        }
+
+        return dict;
+    }
+};
@@ -0,0 +1,66 @@
+#include <Geode/Geode.hpp>
+#include <Geode/modify/CCBMFontConfiguration.hpp>
+
+#include "load/bmfont.hpp"
+#include <settings.hpp>
+#include <tracing.hpp>
+
+#include <cstdlib>
+#include <type_traits>
+
+using namespace geode::prelude;
+
+// Fills font configurations from our parsed (and usually already cached, see load/bmfont.hpp) fonts.
+// The dictionaries are built exactly like cocos does in parseConfigFile, so everything else keeps working as usual.
+// If the font can't be read or parsed, cocos gets to handle it.
+class $modify(CCBMFontConfiguration) {
+    $override
+    bool initWithFNTfile(const char* fntFile) {
+        if (!blaze::settings().fastFonts || !fntFile) {
+            return CCBMFontConfiguration::initWithFNTfile(fntFile);
+        }
+
+        ZoneScoped;
+
+        auto font = blaze::loadFont(fntFile);
+        if (!font) {
+            return CCBMFontConfiguration::initWithFNTfile(fntFile);
+        }
+
+        m_pKerningDictionary = nullptr;
+        m_pFontDefDictionary = nullptr;
+
+        m_nCommonHeight = font->commonHeight;
+        m_tPadding = font->padding;
+
+        auto atlasName = blaze::fontAtlasName(*font, fntFile);
+        m_sAtlasName = gd::string{atlasName.data(), atlasName.size()};
+
+        auto characterSet = new std::remove_pointer_t<decltype(m_pCharacterSet)>();
+
+        // allocated with malloc, cocos frees them with free
+        for (auto& ch : font->chars) {
+            auto element = static_cast<tCCFontDefHashElement*>(std::malloc(sizeof(tCCFontDefHashElement)));
+            element->key = ch.id;
+            element->fontDef.charID = ch.id;
+            element->fontDef.rect = CCRect{ch.x, ch.y, ch.width, ch.height};
+            element->fontDef.xOffset = ch.xOffset;
+            element->fontDef.yOffset = ch.yOffset;
+            element->fontDef.xAdvance = ch.xAdvance;
+
+            HASH_ADD_INT(m_pFontDefDictionary, key, element);
+            characterSet->insert(ch.id);
+        }
+
+        for (auto& kerning : font->kernings) {
+            auto element = static_cast<tCCKerningHashElement*>(std::calloc(1, sizeof(tCCKerningHashElement)));
+            element->key = kerning.key;
+            element->amount = kerning.amount;
+
+            HASH_ADD_INT(m_pKerningDictionary, key, element);
+        }
+
+        m_pCharacterSet = characterSet;
+        return true;
+    }
+};
@@ -0,0 +1,64 @@
+#include <Geode/Geode.hpp>
+
+#ifndef GEODE_IS_MACOS // same as base64, icbb
+
+#include <util/string.hpp>
+
+// Routes CCPointFromString, CCSizeFromString and CCRectFromString through our parsers.
+// GD calls these for fonts, animations and every plist that isn't a sprite sheet. Cocos splits the string
+// into a few std::strings and atof's them, we parse it in place. Anything our parsers don't accept
+// (whitespace, garbage, hex numbers, malformed strings) goes to the original, so the results are always identical.
+
+using namespace geode::prelude;
+
+static CCPoint CCPointFromStringHook(const char* content) {
+    if (content) {
+        if (auto point = blaze::parseCCPoint(content)) {
+            return *point;
+        }
+    }
+
+    return cocos2d::CCPointFromString(content);
+}
+
+static CCSize CCSizeFromStringHook(const char* content) {
+    if (content) {
+        if (auto size = blaze::parseCCPoint<CCSize>(content)) {
+            return *size;
+        }
+    }
+
+    return cocos2d::CCSizeFromString(content);
+}
+
+static CCRect CCRectFromStringHook(const char* content) {
+    if (content) {
+        if (auto rect = blaze::parseCCRect(content)) {
+            return *rect;
+        }
+    }
+
+    return cocos2d::CCRectFromString(content);
+}
+
+$execute {
+    (void) Mod::get()->hook(
+        reinterpret_cast<void*>(addresser::getNonVirtual(cocos2d::CCPointFromString)),
+        CCPointFromStringHook,
+        "cocos2d::CCPointFromString"
+    );
+
+    (void) Mod::get()->hook(
+        reinterpret_cast<void*>(addresser::getNonVirtual(cocos2d::CCSizeFromString)),
+        CCSizeFromStringHook,
+        "cocos2d::CCSizeFromString"
+    );
+
+    (void) Mod::get()->hook(
+        reinterpret_cast<void*>(addresser::getNonVirtual(cocos2d::CCRectFromString)),
+        CCRectFromStringHook,
+        "cocos2d::CCRectFromString"
+    );
+}
+
+#endif
@@ -1,140 +1,246 @@
-// #include <Geode/Geode.hpp>
-// #include <Geode/modify/CCSpriteBatchNode.hpp>
-// #include <Geode/modify/CCSprite.hpp>
-
-// #include <asp/time/Instant.hpp>
-
-// using namespace geode::prelude;
-// using namespace asp::time;
-
-// static Duration g_accumulatedVisitTime{};
-// static Duration g_accumulatedDrawTime{};
-// static size_t g_dirtySprites = 0;
-// static size_t g_notDirtySprites = 0;
-// static size_t g_counter = 0;
-
-// namespace blaze {
-
-// class $modify(BatchNodeHook, CCSpriteBatchNode) {
-//     void visit() {
-//         auto time = Instant::now();
-
-//         if (!m_bVisible) return;
-
-//         kmGLPushMatrix();
-
-//         if (m_pGrid && m_pGrid->isActive()) {
-//             m_pGrid->beforeDraw();
-//             this->transformAncestors();
-//         }
-
-//         this->sortAllChildren();
-//         auto p1 = Instant::now();
-//         this->transform();
-//         auto p2 = Instant::now();
-//         this->BatchNodeHook::draw();
-//         auto p3 = Instant::now();
-
-//         if (m_pGrid && m_pGrid->isActive()) {
-//             m_pGrid->afterDraw(this);
-//         }
-
-//         kmGLPopMatrix();
-
-//         // auto p4 = Instant::now();
-//         // auto elapsed = time.elapsed();
-//         // g_accumulatedVisitTime += elapsed;
-//         // g_accumulatedDrawTime += p3.durationSince(p2);
-
-//         // if (elapsed.micros() > 50) {
-//         //     log::debug(
-//         //         "Batch node visit took {} (sort: {}, transform: {}, draw: {})",
-//         //         elapsed.toString(),
-//         //         (p1.durationSince(time)).toString(),
-//         //         (p2.durationSince(p1)).toString(),
-//         //         (p3.durationSince(p2)).toString()
-//         //     );
-//         // }
-//     }
-
-//     void draw() {
-//         if (m_pobTextureAtlas->getTotalQuads() == 0) return;
-
-//         auto now = Instant::now();
-//         // expansion of CC_NODE_DRAW_SETUP
-//         ccGLEnable(m_eGLServerState);
-//         getShaderProgram()->use();
-//         getShaderProgram()->setUniformsForBuiltins();
-//         // end expansion
-
-//         auto p1 = Instant::now();
-
-//         for (auto child : CCArrayExt<CCSprite>(m_pChildren)) {
-//             if (!child) {
-//                 log::error("Null child in CCSpriteBatchNode children!");
-//                 log::error("This: {}", this);
-//                 for (auto c : CCArrayExt<CCSprite>(m_pChildren)) {
-//                     log::error(" - Child: {}", c);
-//                 }
-//                 __debugbreak();
-//             }
-
-//             // child->isDirty() ? g_dirtySprites++ : g_notDirtySprites++;
-//             child->updateTransform();
-//         }
-
-//         auto p2 = Instant::now();
-
-//         ccGLBlendFunc(m_blendFunc.src, m_blendFunc.dst);
-
-//         m_pobTextureAtlas->drawQuads();
-
-//         auto p3 = Instant::now();
-//         auto elapsed = now.elapsed();
-//         if (elapsed.micros() > 50) {
-//             // log::debug(
-//             //     "Batch node draw took {} (update: {}, draw: {})",
-//             //     elapsed.toString(),
-//             //     (p2.durationSince(p1)).toString(),
-//             //     (p3.durationSince(p2)).toString()
-//             // );
-//         }
-//     }
-// };
-
-// // void setDirtyHook(CCSprite* self, bool dirty) {
-// //     bool matters = self->m_pParent && self->m_pParent->m_pParent;
-// //     if (dirty && matters) {
-// //         log::debug("Dirtifying {} (parent: {})", self, self->getParent());
-
-// //         g_counter++;
-// //         if (g_counter == 200000) {
-// //             __debugbreak();
-// //         }
-// //     }
-
-// //     self->CCSprite::setDirty(dirty);
-// // }
-
-// // $execute {
-// //     Mod::get()->hook(
-// //         (void*)(base::getCocos() + 0x04bc40),
-// //         &setDirtyHook,
-// //         "CCSprite::setDirty"
-// //     ).unwrap();
-// // }
-
-// struct FakeGM : public CCObject {
-//     void printTime(float) {
-//         // log::debug("Accumulated visit time: {}, of which draw time: {}", g_accumulatedVisitTime.toString(), g_accumulatedDrawTime.toString());
-//         // log::debug("Dirty sprites: {}, not dirty: {}", g_dirtySprites, g_notDirtySprites);
-//     }
-// };
-
-// // $on_mod(Loaded) {
-// //     auto gm = GameManager::get();
-// //     gm->schedule(schedule_selector(FakeGM::printTime), 5.f);
-// //     gm->onEnter();
-// // }
-
-// }
+#include <Geode/Geode.hpp>
+#include <Geode/modify/CCSpriteBatchNode.hpp>
+#include <Geode/modify/CCTextureAtlas.hpp>
+
+#include <settings.hpp>
+#include <tracing.hpp>
+#include <util/parallel.hpp>
+
+#include "CCSpriteBatchNode.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+// Parallel sprite transforms.
+//
+// Before drawing, a batch node calls `updateTransform` on each of its children, which recomputes the quad of every dirty sprite
+// and writes it into the texture atlas at the sprite's own atlas index, then does the same for the sprite's children.
+// A sprite only reads its own state and that of its ancestors, so the subtrees of different children are independent,
+// and every sprite in the batch has a distinct atlas index, so different subtrees never write to the same quad.
+// This means the children can be handed out to the worker threads in batches, giving the exact same quads as the plain loop.
+//
+// The only shared state that gets written is the atlas' total quad count and dirty flag, in `CCTextureAtlas::updateQuad`.
+// On the worker threads, `updateQuad` only copies the quad, after checking on the main thread that every sprite's quad is
+// inside of the atlas (so the game would leave the count as is), and the atlas is made dirty once the workers are done,
+// if any of them wrote a quad.
+//
+// Partial quad uploads.
+//
+// When any quad changes, the atlas uploads its whole quad buffer again, which is a lot of data for a big batch node in which
+// only a few objects are animated. Instead, the batch node keeps a copy of what was last uploaded, compares it with the
+// current quads, and only uploads the ranges that differ. The buffer on the GPU ends up with the same contents either way.
+// The copy is only trusted as long as the atlas, its buffer and its size stay the same, otherwise the game uploads everything.
+
+using namespace geode::prelude;
+
+namespace {
+    // Gives access to the quad buffer of the atlas
+    struct CCTextureAtlasExt : public CCTextureAtlas {
+        GLuint getVertexBuffer() const {
+            return m_pBuffersVBO[0];
+        }
+    };
+
+    // set while a thread updates its share of the sprites of a batch node in parallel
+    thread_local bool t_quadsOnly = false;
+    thread_local bool t_wroteQuad = false;
+}
+
+namespace blaze {
+
+// Most batch nodes have few children, and most of those are not dirty on a given frame, so only big ones are split up.
+static constexpr size_t PARALLEL_SPRITE_THRESHOLD = 1024;
+static constexpr size_t SPRITE_BATCH_SIZE = 256;
+
+// Smaller atlases are cheap enough to upload whole, so they don't need a copy kept around.
+static constexpr size_t PARTIAL_UPLOAD_THRESHOLD = 512;
+// Changed ranges closer than this are uploaded as one, a few extra quads cost less than another call.
+static constexpr size_t UPLOAD_MERGE_GAP = 32;
+
+struct QuadRange {
+    size_t begin, end;
+};
+
+// Appends the ranges of quads that differ between `a` and `b` to `out`, merging the ones that are close together.
+static void findChangedQuads(const ccV3F_C4B_T2F_Quad* a, const ccV3F_C4B_T2F_Quad* b, size_t count, std::vector<QuadRange>& out) {
+    // most quads don't change, so compare large blocks first
+    constexpr size_t BLOCK = 16;
+
+    size_t i = 0;
+    while (i < count) {
+        size_t blockEnd = std::min(i + BLOCK, count);
+        if (std::memcmp(a + i, b + i, (blockEnd - i) * sizeof(*a)) == 0) {
+            i = blockEnd;
+            continue;
+        }
+
+        for (; i < blockEnd; i++) {
+            if (std::memcmp(a + i, b + i, sizeof(*a)) == 0) continue;
+
+            if (!out.empty() && i - out.back().end <= UPLOAD_MERGE_GAP) {
+                out.back().end = i + 1;
+            } else {
+                out.push_back({i, i + 1});
+            }
+        }
+    }
+}
+
+// Whether every sprite in `children` and below writes its quad into `atlas`, inside of the quads it already has.
+static bool quadsInAtlas(CCArray* children, CCTextureAtlas* atlas) {
+    if (!children) return true;
+
+    size_t total = atlas->getTotalQuads();
+
+    for (auto sprite : CCArrayExt<CCSprite>(children)) {
+        if (sprite->getTextureAtlas() != atlas || sprite->getAtlasIndex() >= total) return false;
+        if (!quadsInAtlas(sprite->getChildren(), atlas)) return false;
+    }
+
+    return true;
+}
+
+void updateBatchTransforms(CCSpriteBatchNode* node, bool parallel) {
+    auto children = node->getChildren();
+    if (!children || children->count() == 0) return;
+
+    size_t count = children->data->num;
+    auto sprites = reinterpret_cast<CCSprite**>(children->data->arr);
+    auto atlas = node->getTextureAtlas();
+
+    if (!parallel || !quadsInAtlas(children, atlas)) {
+        for (size_t i = 0; i < count; i++) {
+            sprites[i]->updateTransform();
+        }
+
+        return;
+    }
+
+    std::atomic<bool> wroteQuad = false;
+
+    WorkerGroup::get().parallelFor(count, SPRITE_BATCH_SIZE, [&](size_t begin, size_t end) {
+        t_quadsOnly = true;
+        t_wroteQuad = false;
+
+        for (size_t i = begin; i < end; i++) {
+            sprites[i]->updateTransform();
+        }
+
+        t_quadsOnly = false;
+        if (t_wroteQuad) {
+            wroteQuad.store(true, std::memory_order_relaxed);
+        }
+    });
+
+    if (wroteQuad.load(std::memory_order_relaxed)) {
+        atlas->setDirty(true);
+    }
+}
+
+class $modify(BatchAtlasHook, CCTextureAtlas) {
+    $override
+    void updateQuad(ccV3F_C4B_T2F_Quad* quad, unsigned int index) {
+        if (!t_quadsOnly) {
+            return CCTextureAtlas::updateQuad(quad, index);
+        }
+
+        // the index was checked to be below the total quad count, which is all the game does besides copying
+        m_pQuads[index] = *quad;
+        t_wroteQuad = true;
+    }
+};
+
+class $modify(BatchNodeHook, CCSpriteBatchNode) {
+    struct Fields {
+        // what was last uploaded to the quad buffer of the atlas
+        std::vector<ccV3F_C4B_T2F_Quad> uploaded;
+        CCTextureAtlas* atlas = nullptr;
+        size_t capacity = 0;
+        GLuint buffer = 0;
+        std::vector<QuadRange> ranges;
+    };
+
+    $override
+    void draw() {
+        bool parallel = blaze::settings().parallelSprites && m_pChildren && m_pChildren->count() >= PARALLEL_SPRITE_THRESHOLD;
+        bool partial = blaze::settings().partialUploads && m_pobTextureAtlas->getTotalQuads() >= PARTIAL_UPLOAD_THRESHOLD;
+
+        if (!parallel && !partial) {
+            // the game is going to upload without us knowing, so the copy can't be trusted anymore
+            this->forgetUploadedQuads();
+            CCSpriteBatchNode::draw();
+            return;
+        }
+
+        ZoneScoped;
+
+        if (m_pobTextureAtlas->getTotalQuads() == 0) return;
+
+        // expansion of CC_NODE_DRAW_SETUP
+        ccGLEnable(m_eGLServerState);
+        getShaderProgram()->use();
+        getShaderProgram()->setUniformsForBuiltins();
+
+        updateBatchTransforms(this, parallel);
+
+        if (partial) {
+            this->uploadChangedQuads();
+        } else {
+            this->forgetUploadedQuads();
+        }
+
+        ccGLBlendFunc(m_blendFunc.src, m_blendFunc.dst);
+        m_pobTextureAtlas->drawQuads();
+    }
+
+    void forgetUploadedQuads() {
+        auto fields = m_fields.self();
+        if (fields->atlas) {
+            fields->atlas = nullptr;
+            fields->uploaded = {};
+        }
+    }
+
+    // Uploads the quads that changed since the last upload and clears the dirty flag of the atlas,
+    // or if the last upload is not known, leaves the atlas to upload everything in `drawQuads`.
+    void uploadChangedQuads() {
+        auto atlas = static_cast<CCTextureAtlasExt*>(m_pobTextureAtlas);
+        if (!atlas->isDirty()) return;
+
+        ZoneScoped;
+
+        auto fields = m_fields.self();
+        auto quads = atlas->getQuads();
+        size_t count = atlas->getTotalQuads();
+
+        if (fields->atlas != atlas || fields->capacity != atlas->getCapacity() || fields->buffer != atlas->getVertexBuffer() || fields->uploaded.size() != count) {
+            fields->atlas = atlas;
+            fields->capacity = atlas->getCapacity();
+            fields->buffer = atlas->getVertexBuffer();
+            fields->uploaded.assign(quads, quads + count);
+            return;
+        }
+
+        auto& ranges = fields->ranges;
+        ranges.clear();
+        findChangedQuads(quads, fields->uploaded.data(), count, ranges);
+
+        if (!ranges.empty()) {
+            glBindBuffer(GL_ARRAY_BUFFER, fields->buffer);
+
+            for (auto& range : ranges) {
+                size_t size = (range.end - range.begin) * sizeof(*quads);
+                glBufferSubData(GL_ARRAY_BUFFER, range.begin * sizeof(*quads), size, quads + range.begin);
+                std::memcpy(fields->uploaded.data() + range.begin, quads + range.begin, size);
+            }
+
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        atlas->setDirty(false);
+    }
+};
+
+}
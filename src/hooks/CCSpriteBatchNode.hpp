@@ -0,0 +1,9 @@
+#pragma once
+
+#include <Geode/Geode.hpp>
+
+namespace blaze {
+    // Updates the quads of every sprite in the batch node, the same as the loop in `CCSpriteBatchNode::draw`.
+    // With `parallel`, the children are split up between the worker threads, unless some sprite's quad is not in the atlas yet.
+    void updateBatchTransforms(cocos2d::CCSpriteBatchNode* node, bool parallel);
+}
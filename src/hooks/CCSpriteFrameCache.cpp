@@ -6,30 +6,188 @@
 #include <Geode/modify/CCSpriteFrameCache.hpp>
 
 #include "CCTextureCache.hpp"
+#include "load/framecache.hpp"
+#include "load/lazy.hpp"
 #include <util/assert.hpp>
+#include <util/concurrent_index.hpp>
 #include <util/hash.hpp>
+#include <util/perfect_hash.hpp>
 #include <manager.hpp>
 #include <TaskTimer.hpp>
+#include <settings.hpp>
+#include <tracing.hpp>
 
 using namespace geode::prelude;
 
 namespace blaze {
     asp::Mutex<> g_sfcacheMutex;
-    asp::Mutex<std::unordered_map<size_t, std::shared_ptr<SpriteFrameData>>> g_spfCache;
+    IdMap<CCSpriteFrame*> g_spriteFrameIndex{nullptr};
+    ConcurrentIndex<std::shared_ptr<SpriteFrameData>> g_spfCache;
+
+    // Immutable set of names (the vanilla frames, in practice), only the frame pointers can be updated in place.
+    struct SpriteFrameTable {
+        struct Entry {
+            uint64_t hash;
+            const char* name; // interned, as the dictionary frees its keys when a frame is replaced
+            std::atomic<CCSpriteFrame*> frame;
+        };
+
+        PerfectHash phf;
+        std::unique_ptr<Entry[]> entries;
+        size_t count = 0;
+
+        Entry* find(const char* name) const {
+            uint64_t hash = hashStringRuntime64(name);
+            Entry& entry = entries[phf.slot(hash)];
+
+            return (entry.hash == hash && std::strcmp(entry.name, name) == 0) ? &entry : nullptr;
+        }
+    };
+
+    static std::atomic<SpriteFrameTable*> g_frameTable{nullptr};
+
+    // Dropped tables may still be read by other threads, they are only freed when the next one is built after loading.
+    static asp::Mutex<std::vector<std::unique_ptr<SpriteFrameTable>>> g_retiredFrameTables;
+
+    static void dropSpriteFrameTable() {
+        if (auto table = g_frameTable.exchange(nullptr, std::memory_order::acq_rel)) {
+            g_retiredFrameTables.lock()->emplace_back(table);
+        }
+    }
+
+    void buildSpriteFrameTable() {
+        ZoneScoped;
+
+        dropSpriteFrameTable();
+
+        auto table = std::make_unique<SpriteFrameTable>();
+        std::vector<std::pair<const char*, CCSpriteFrame*>> frames;
+        std::vector<uint64_t> hashes;
+
+        {
+            auto _lck = g_sfcacheMutex.lock();
+            auto dict = CCSpriteFrameCache::get()->m_pSpriteFrames;
+
+            frames.reserve(dict->count());
+            hashes.reserve(dict->count());
+
+            CCDictElement* elem;
+            CCDICT_FOREACH(dict, elem) {
+                auto name = internedString(internString(elem->getStrKey()));
+                frames.emplace_back(name, static_cast<CCSpriteFrame*>(elem->getObject()));
+                hashes.push_back(hashStringRuntime64(name));
+            }
+        }
+
+        if (frames.empty()) {
+            return;
+        }
+
+        auto phf = PerfectHash::build(hashes);
+        if (!phf) {
+            log::warn("Failed to build sprite frame table for {} frames, using the index only", frames.size());
+            return;
+        }
+
+        table->phf = std::move(*phf);
+        table->entries.reset(new SpriteFrameTable::Entry[frames.size()]);
+        table->count = frames.size();
+
+        for (size_t i = 0; i < frames.size(); i++) {
+            auto& entry = table->entries[table->phf.slot(hashes[i])];
+            entry.hash = hashes[i];
+            entry.name = frames[i].first;
+            entry.frame.store(frames[i].second, std::memory_order::relaxed);
+        }
+
+        // all loading threads are done by now, nobody can be looking at the old tables anymore
+        g_retiredFrameTables.lock()->clear();
+
+        g_frameTable.store(table.release(), std::memory_order::release);
+    }
+
+    void updateSpriteFrameTable(const char* name, CCSpriteFrame* frame) {
+        if (auto table = g_frameTable.load(std::memory_order::acquire)) {
+            if (auto entry = table->find(name)) {
+                entry->frame.store(frame, std::memory_order::release);
+            }
+        }
+    }
+
+    // Drops the frame of the name from the index and the table, before or after it's removed from the dictionary.
+    static void forgetSpriteFrame(const char* name) {
+        g_spriteFrameIndex.set(findInternedString(name), nullptr);
+        updateSpriteFrameTable(name, nullptr);
+    }
+
+    struct KnownFrame {
+        StringId id;
+        CCSpriteFrame* frame;
+    };
+
+    // The frames of the dictionary that can be indexed (those with interned names), optionally only the ones using `texture`.
+    // Taken before a vanilla removal, to find out what it removed with `forgetRemovedSpriteFrames`.
+    static std::vector<KnownFrame> snapshotSpriteFrames(CCDictionary* frames, CCTexture2D* texture = nullptr) {
+        std::vector<KnownFrame> out;
+
+        CCDictElement* elem;
+        CCDICT_FOREACH(frames, elem) {
+            auto frame = static_cast<CCSpriteFrame*>(elem->getObject());
+            if (texture && frame->getTexture() != texture) continue;
+
+            auto id = findInternedString(elem->getStrKey());
+            if (id != INVALID_STRING_ID) {
+                out.push_back({id, frame});
+            }
+        }
+
+        return out;
+    }
+
+    static void forgetRemovedSpriteFrames(CCDictionary* frames, const std::vector<KnownFrame>& before) {
+        for (auto& known : before) {
+            auto name = internedString(known.id);
+            if (frames->objectForKey(name) != known.frame) {
+                g_spriteFrameIndex.set(known.id, nullptr);
+                updateSpriteFrameTable(name, nullptr);
+            }
+        }
+    }
+
+    // Keeps the names, as they are all added back when the game's sheets are loaded again.
+    static void clearSpriteFrameTable() {
+        if (auto table = g_frameTable.load(std::memory_order::acquire)) {
+            for (size_t i = 0; i < table->count; i++) {
+                table->entries[i].frame.store(nullptr, std::memory_order::release);
+            }
+        }
+    }
+
+    size_t removeUnusedSpriteFrames(CCDictionary* frames) {
+        size_t removed = 0;
+
+        CCDictElement* elem;
+        CCDICT_FOREACH(frames, elem) {
+            if (isSpriteFrameUnused(static_cast<CCSpriteFrame*>(elem->getObject()))) {
+                forgetSpriteFrame(elem->getStrKey());
+                frames->removeObjectForElememt(elem);
+                removed++;
+            }
+        }
+
+        return removed;
+    }
 
     std::shared_ptr<SpriteFrameData> loadSpriteFrames(const char* path) {
         BLAZE_ASSERT(path != nullptr);
 
-        auto hash = blaze::hashStringRuntime(path);
+        auto hash = blaze::hashStringRuntime64(path);
 
-        {
-            auto cache = g_spfCache.lock();
-            if (cache->contains(hash)) {
+        if (auto cached = g_spfCache.find(path, hash)) {
 #ifdef BLAZE_DEBUG
-                log::debug("loadSpriteFrames cache hit! for {}", path);
+            log::debug("loadSpriteFrames cache hit! for {}", path);
 #endif
-                return cache->at(hash);
-            }
+            return std::move(*cached);
         }
 
 #ifdef BLAZE_DEBUG
@@ -40,19 +198,145 @@ namespace blaze {
         auto data = LoadManager::get().readFile(path, size, false);
         auto dataptr = data.release();
 
-        auto result = blaze::parseSpriteFrames(dataptr, size, true);
+        auto result = blaze::parseSpriteFramesCached(dataptr, size, true);
         if (!result) {
             log::warn("Failed to parse sprite frames for {}: {}", path, result.unwrapErr());
             return nullptr;
         }
 
         std::shared_ptr<SpriteFrameData> spf = std::move(result).unwrap();
-        g_spfCache.lock()->emplace(hash, spf);
+        g_spfCache.insert(path, hash, spf);
 
         return spf;
     }
 }
 
+class $modify(HookedSpriteFrameCache, CCSpriteFrameCache) {
+    $override
+    CCSpriteFrame* spriteFrameByName(const char* name) {
+        // frames in the table are always loaded already, so this can go before the lazy sheet check
+        blaze::SpriteFrameTable::Entry* entry = nullptr;
+        if (auto table = blaze::g_frameTable.load(std::memory_order::acquire)) {
+            entry = table->find(name);
+            if (entry) {
+                if (auto frame = entry->frame.load(std::memory_order::acquire)) {
+                    return frame;
+                }
+            }
+        }
+
+        // loads lazy sprite sheets the first time they are needed
+        if (blaze::settings().lazySheets) {
+            blaze::LazySheets::get().ensureLoadedForFrame(name);
+        }
+
+        // the table entry of a frame that was removed is empty, until the frame is found again
+        if (auto frame = blaze::g_spriteFrameIndex.get(blaze::findInternedString(name))) {
+            if (entry) entry->frame.store(frame, std::memory_order::release);
+            return frame;
+        }
+
+        auto frame = CCSpriteFrameCache::spriteFrameByName(name);
+
+        // don't remember frames found through aliases, the index is only kept in sync with the frames themselves
+        if (frame && m_pSpriteFrames->objectForKey(name) == frame) {
+            blaze::g_spriteFrameIndex.set(blaze::internString(name), frame);
+            if (entry) entry->frame.store(frame, std::memory_order::release);
+        }
+
+        return frame;
+    }
+
+    $override
+    void addSpriteFramesWithFile(const char* plist) {
+        if (blaze::settings().lazySheets && blaze::LazySheets::get().ensureLoadedForPlist(plist)) {
+            return;
+        }
+
+        CCSpriteFrameCache::addSpriteFramesWithFile(plist);
+    }
+
+    $override
+    void addSpriteFrame(CCSpriteFrame* frame, const char* name) {
+        // before the old frame is released
+        blaze::updateSpriteFrameTable(name, frame);
+        blaze::g_spriteFrameIndex.set(blaze::findInternedString(name), nullptr);
+
+        CCSpriteFrameCache::addSpriteFrame(frame, name);
+    }
+
+    // Called once the removed frames are out of the index and the table.
+    // Frees the sprite frame slabs (see load/frameslab.hpp) that are no longer used.
+    static void onFramesRemoved() {
+        blaze::sweepSpriteFrameSlabs();
+    }
+
+    $override
+    static void purgeSharedSpriteFrameCache() {
+        CCSpriteFrameCache::purgeSharedSpriteFrameCache();
+        blaze::g_spriteFrameIndex.clear();
+        blaze::clearSpriteFrameTable();
+        onFramesRemoved();
+    }
+
+    $override
+    void removeSpriteFrames() {
+        CCSpriteFrameCache::removeSpriteFrames();
+        blaze::g_spriteFrameIndex.clear();
+        blaze::clearSpriteFrameTable();
+        onFramesRemoved();
+    }
+
+    // Reimplemented, vanilla only removes frames with a refcount of 1, which frames in slabs never have.
+    $override
+    void removeUnusedSpriteFrames() {
+        ZoneScoped;
+
+        size_t removed;
+        {
+            auto _lck = blaze::g_sfcacheMutex.lock();
+            removed = blaze::removeUnusedSpriteFrames(m_pSpriteFrames);
+
+            // there's no telling which plists the removed frames came from, so all of them have to be loaded again
+            if (removed) {
+                m_pLoadedFileNames->clear();
+            }
+        }
+
+        onFramesRemoved();
+    }
+
+    $override
+    void removeSpriteFrameByName(const char* name) {
+        if (!name) return;
+
+        // vanilla removes the frame the alias points to, along with the alias
+        auto key = static_cast<CCString*>(m_pSpriteFramesAliases->objectForKey(name));
+        blaze::forgetSpriteFrame(key ? key->getCString() : name);
+
+        CCSpriteFrameCache::removeSpriteFrameByName(name);
+        onFramesRemoved();
+    }
+
+    $override
+    void removeSpriteFramesFromFile(const char* plist) {
+        auto before = blaze::snapshotSpriteFrames(m_pSpriteFrames);
+        CCSpriteFrameCache::removeSpriteFramesFromFile(plist);
+
+        blaze::forgetRemovedSpriteFrames(m_pSpriteFrames, before);
+        onFramesRemoved();
+    }
+
+    $override
+    void removeSpriteFramesFromTexture(CCTexture2D* texture) {
+        auto before = blaze::snapshotSpriteFrames(m_pSpriteFrames, texture);
+        CCSpriteFrameCache::removeSpriteFramesFromTexture(texture);
+
+        blaze::forgetRemovedSpriteFrames(m_pSpriteFrames, before);
+        onFramesRemoved();
+    }
+};
+
 // Decided not to go for this hook as there hasn't been a significant enough improvement.
 
 // class $modify(CCSpriteFrameCache) {
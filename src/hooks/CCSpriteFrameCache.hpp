@@ -1,12 +1,30 @@
 #pragma once
 
 #include <asp/sync/Mutex.hpp>
+#include <util/intern.hpp>
 
 #include "load/spriteframes.hpp"
 
 namespace blaze {
     extern asp::Mutex<> g_sfcacheMutex;
 
+    // Lock-free index in front of `m_pSpriteFrames`, keyed by the interned frame name.
+    // Only holds names that are keys of the dictionary itself, never aliases.
+    extern IdMap<cocos2d::CCSpriteFrame*> g_spriteFrameIndex;
+
+    // Builds a perfect hash table over every frame currently in the cache, which `spriteFrameByName` checks first.
+    // Should be called on the main thread once the game's sheets are loaded. Frames added later are found through the index.
+    // Removing frames only empties their entries, which get filled again once the frames are added back and looked up.
+    void buildSpriteFrameTable();
+
+    // Points the table entry of the frame name (if it has one) to the new frame. Must be called before the dictionary
+    // releases the old frame, as other threads could still be handed it by `spriteFrameByName` otherwise.
+    void updateSpriteFrameTable(const char* name, cocos2d::CCSpriteFrame* frame);
+
+    // Removes the frames that are only referenced by the dictionary, like `CCSpriteFrameCache::removeUnusedSpriteFrames`,
+    // but also counting frames in slabs whose only other reference is their slab. Returns the amount of removed frames.
+    size_t removeUnusedSpriteFrames(cocos2d::CCDictionary* frames);
+
     // Parses data from a .plist file into a structure holding many sprite frames.
     // Will cache them, if the plist has already been loaded, it will not be reloaded.
     std::shared_ptr<SpriteFrameData> loadSpriteFrames(const char* path);
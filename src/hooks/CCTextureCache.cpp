@@ -6,11 +6,19 @@
 #include <ccimageext.hpp>
 #include <manager.hpp>
 #include <fpff.hpp>
+#include <util/intern.hpp>
+#include <util/thread.hpp>
+
+#include "load/pbo.hpp"
 
 using namespace geode::prelude;
 
 static asp::Mutex<> s_texturesMutex;
 
+// Lock-free index in front of `m_pTextures`, keyed by the interned full path. Misses fall through to the dictionary,
+// so textures added by vanilla code are still found, they just take the slow path the first time.
+static blaze::IdMap<CCTexture2D*> s_textureIndex{nullptr};
+
 namespace blaze {
 
 BTextureCache& BTextureCache::get() {
@@ -20,11 +28,13 @@ BTextureCache& BTextureCache::get() {
 void BTextureCache::removeTexture(const gd::string& key) {
     auto _lck = s_texturesMutex.lock();
     this->m_pTextures->removeObjectForKey(key);
+    s_textureIndex.set(findInternedString(std::string_view{key.data(), key.size()}), nullptr);
 }
 
 void BTextureCache::setTexture(const gd::string& key, CCTexture2D* texture) {
     auto _lck = s_texturesMutex.lock();
     this->m_pTextures->setObject(texture, key);
+    s_textureIndex.set(internString(std::string_view{key.data(), key.size()}), texture);
 }
 
 static bool equalIgnoreCase(std::string_view a, std::string_view b) {
@@ -42,18 +52,22 @@ static bool equalIgnoreCase(std::string_view a, std::string_view b) {
 }
 
 CCTexture2D* BTextureCache::loadTexture(const char* path, bool ignoreSuffix) {
-    blaze::ThreadSafeFileUtilsGuard _guard;
-
-    auto fullPath = blaze::fullPathForFilename(path, ignoreSuffix);
-    if (fullPath.empty()) {
+    StringId pathId = blaze::fullPathIdForFilename(path, ignoreSuffix);
+    if (pathId == INVALID_STRING_ID) {
         return nullptr;
     }
 
+    if (auto tex = s_textureIndex.get(pathId)) {
+        return tex;
+    }
+
+    gd::string fullPath{internedString(pathId)};
     std::string_view fullPathsv = std::string_view(fullPath.data(), fullPath.size());
 
     {
         auto _lck = s_texturesMutex.lock();
         if (auto tex = this->m_pTextures->objectForKey(fullPath)) {
+            s_textureIndex.set(pathId, static_cast<CCTexture2D*>(tex));
             return static_cast<CCTexture2D*>(tex);
         }
     }
@@ -86,17 +100,37 @@ CCTexture2D* BTextureCache::loadTexture(const char* path, bool ignoreSuffix) {
         return nullptr;
     }
 
-    auto texture = new CCTexture2D();
-    if (!texture->initWithImage(image)) {
-        log::warn("Texture init failed, this is very bad!");
-        log::warn("Path: {}", fullPath);
-        texture->release();
-        image->release();
-        return nullptr;
+    CCTexture2D* texture = nullptr;
+
+    // pixel buffers are only around while the game is loading
+    auto& uploader = PboUploader::get();
+    if (uploader.isActive() && blaze::isMainThread()) {
+        if (auto staging = uploader.stage(image)) {
+            texture = uploader.upload(*staging);
+
+            // staging already freed the pixels of the image, so there's nothing to fall back to
+            if (!texture) {
+                log::warn("Failed to upload texture from pixel buffer ({})", fullPath);
+                image->release();
+                return nullptr;
+            }
+        }
+    }
+
+    if (!texture) {
+        texture = new CCTexture2D();
+        if (!texture->initWithImage(image)) {
+            log::warn("Texture init failed, this is very bad!");
+            log::warn("Path: {}", fullPath);
+            texture->release();
+            image->release();
+            return nullptr;
+        }
     }
 
     auto _lck = s_texturesMutex.lock();
     this->m_pTextures->setObject(texture, fullPath);
+    s_textureIndex.set(pathId, texture);
 
     texture->release();
     image->release();
@@ -109,6 +143,42 @@ struct CCTextureCacheHook : Modify<CCTextureCacheHook, CCTextureCache> {
     CCTexture2D* addImage(const char* path, bool ignoreSuffix) {
         return BTextureCache::get().loadTexture(path, ignoreSuffix);
     }
+
+    // Anything removed through vanilla functions invalidates the whole index.
+
+    static void resetIndex() {
+        s_textureIndex.clear();
+    }
+
+    $override
+    static void purgeSharedTextureCache() {
+        CCTextureCache::purgeSharedTextureCache();
+        resetIndex();
+    }
+
+    $override
+    void removeAllTextures() {
+        CCTextureCache::removeAllTextures();
+        resetIndex();
+    }
+
+    $override
+    void removeUnusedTextures() {
+        CCTextureCache::removeUnusedTextures();
+        resetIndex();
+    }
+
+    $override
+    void removeTexture(CCTexture2D* texture) {
+        CCTextureCache::removeTexture(texture);
+        resetIndex();
+    }
+
+    $override
+    void removeTextureForKey(const char* key) {
+        CCTextureCache::removeTextureForKey(key);
+        resetIndex();
+    }
 };
 
 } // namespace blaze
\ No newline at end of file
@@ -1,797 +1,879 @@
-// #include <Geode/Geode.hpp>
-// #include <Geode/modify/GJBaseGameLayer.hpp>
-// #include <Geode/modify/PlayLayer.hpp>
-
-// #include <asp/time/Instant.hpp>
-// #include <asp/sync/SpinLock.hpp>
-// #include <asp/sync/Notify.hpp>
-// #include <asp/thread.hpp>
-// #include <asp/iter.hpp>
-// #include <util.hpp>
-
-// #ifdef ASP_IS_X86
-// # include <immintrin.h>
-// #else
-// # include <arm_acle.h>
-// #endif
-
-// static void microYield() {
-// #ifdef ASP_IS_X86
-//     _mm_pause();
-// #else
-//     __yield();
-// #endif
-// }
-
-// using namespace geode::prelude;
-// using namespace asp::time;
-
-// namespace blaze {
-
-// static asp::SpinLock<int> g_groupLock;
-// static asp::SpinLock<int> g_raLock;
-// static asp::SpinLock<int> g_maLock;
-// static asp::SpinLock<int> g_sectionLock;
-// static asp::SpinLock<int> g_testLock;
-
-// #pragma clang diagnostic push
-// #pragma clang diagnostic ignored "-Winvalid-offsetof"
-// constexpr auto OBJECT_LOCK_OFFSET = offsetof(GameObject, m_detailUsesHSV) + 1;
-// #pragma clang diagnostic pop
-
-// static ASP_FORCE_INLINE std::atomic_uint8_t& getObjectLock(GameObject* obj) {
-//     // use padding byte after m_detailUsesHSV as a mutex byte
-//     return *reinterpret_cast<std::atomic_uint8_t*>(
-//         reinterpret_cast<uint8_t*>(obj) + OBJECT_LOCK_OFFSET
-//     );
-// }
-
-// struct ObjectLockGuard {
-//     GameObject* obj;
-
-//     ASP_FORCE_INLINE ObjectLockGuard(GameObject* obj) : obj(obj) {
-//         asp::acquireAtomicLock(reinterpret_cast<volatile uint8_t*>(&getObjectLock(obj)));
-//     }
-
-//     ASP_FORCE_INLINE ~ObjectLockGuard() {
-//         asp::releaseAtomicLock(reinterpret_cast<volatile uint8_t*>(&getObjectLock(obj)));
-//     }
-// };
-
-// struct ThreadPool {
-// public:
-//     using Task = std::function<void()>;
-
-//     ThreadPool(size_t threads = std::thread::hardware_concurrency()) : m_storage(std::make_shared<Storage>()) {
-//         auto workers = std::make_unique<Worker[]>(threads);
-//         m_storage->workers = std::move(workers);
-//         m_storage->workerCount = threads;
-
-//         for (size_t i = 0; i < threads; i++) {
-//             std::thread thread([storage = m_storage, i] {
-//                 auto& worker = storage->workers[i];
-//                 auto& tasks = storage->tasks;
-//                 auto& notify = storage->notify;
-
-//                 while (true) {
-//                     auto queue = tasks.lock();
-//                     if (queue->empty()) {
-//                         queue.unlock();
-//                         notify.wait();
-//                         continue;
-//                     }
-
-//                     auto task = std::move(queue->front());
-//                     queue->pop_front();
-//                     queue.unlock();
-
-//                     worker.working.store(true, std::memory_order_relaxed);
-//                     task();
-//                     worker.working.store(false, std::memory_order_relaxed);
-//                 }
-//             });
-
-//             new (&m_storage->workers[i]) Worker{
-//                 .thread = std::move(thread),
-//                 .working = false
-//             };
-//         }
-//     }
-
-//     ~ThreadPool() {
-//         m_destructing = true;
-//         this->join();
-//     }
-
-//     ThreadPool(const ThreadPool&) = delete;
-//     ThreadPool& operator=(const ThreadPool&) = delete;
-
-//     void pushTask(const Task& task) {
-//         m_storage->tasks.lock()->push_back(task);
-//         m_storage->notify.notifyOne();
-//     }
-
-//     void pushTask(Task&& task) {
-//         m_storage->tasks.lock()->push_back(std::move(task));
-//         m_storage->notify.notifyOne();
-//     }
-
-//     void join() {
-//         while (!m_storage->tasks.lock()->empty()) {
-//             // if we are destructing, it's possible that all threads are already dead, just terminate
-//             if (m_destructing) {
-//                 return;
-//             }
-
-//             microYield();
-//         }
-
-//         // wait for all workers to finish
-//         bool stillWorking;
-
-//         do {
-//             if (m_destructing) {
-//                 return;
-//             }
-
-//             microYield();
-
-//             stillWorking = false;
-//             for (size_t i = 0; i < m_storage->workerCount; i++) {
-//                 if (m_storage->workers[i].working.load(std::memory_order_relaxed)) {
-//                     stillWorking = true;
-//                     break;
-//                 }
-//             }
-//         } while (stillWorking);
-//     }
-
-// private:
-//     struct Worker {
-//         std::thread thread;
-//         std::atomic_bool working = false;
-//     };
-
-//     struct Storage {
-//         std::unique_ptr<Worker[]> workers;
-//         size_t workerCount = 0;
-//         asp::SpinLock<std::deque<Task>> tasks;
-//         asp::Notify notify;
-//     };
-
-//     std::shared_ptr<Storage> m_storage;
-//     bool m_destructing = false;
-// };
-
-// class $modify(ParallelGJBGL, GJBaseGameLayer) {
-//     struct Fields {
-//         std::optional<ThreadPool> m_threadPool;
-//     };
-
-//     ThreadPool& getPool() {
-//         auto& fields = *m_fields.self();
-
-//         if (!fields.m_threadPool) {
-//             fields.m_threadPool.emplace();
-//         }
-
-//         return fields.m_threadPool.value();
-//     }
-
-//     $override
-//     void processMoveActionsStep(float p0, bool p1) {
-//         if (m_isEditor) {
-//             return GJBaseGameLayer::processMoveActionsStep(p0, p1);
-//         }
-
-//         // log::debug("Processing move actions step with p0 = {}, p1 = {}", p0, p1);
-
-//         m_unked0 = 0;
-//         m_disabledObjectsCount = 0;
-//         m_unked8 = 0;
-//         m_areaObjectsCount = 0;
-
-//         for (auto& act : m_gameState.m_dynamicObjActions1) {
-//             int gid = static_cast<EffectGameObject*>(act.m_gameObject1)->m_targetGroupID;
-//             auto command = m_effectManager->tryGetMoveCommandNode(gid);
-//             if (command) command->m_unk0d1 = true;
-//         }
-
-//         this->processDynamicObjectActions(1, p0);
-//         this->processTransformActions(p1);
-//         this->processRotationActionsReimpl();
-//         this->processDynamicObjectActions(0, p0);
-//         this->processMoveActionsReimpl();
-//         this->processPlayerFollowActions(p0);
-//         this->processAdvancedFollowActions(p0);
-//         this->processFollowActions();
-//         this->processAreaActions(p0, p1);
-
-//         if (m_isEditor && m_disabledObjectsCount > 0) {
-//             for (int i = 0; i < m_disabledObjectsCount; i++) {
-//                 auto obj = m_disabledObjects[i];
-//                 obj->quickUpdatePosition();
-//             }
-//         }
-//     }
-
-//     // -- Below: rotation reimpl --
-
-//     void processRotationActionsReimpl() {
-//         auto p1 = Instant::now();
-
-//         float sx = m_objectLayer->getScaleX();
-//         float sy = m_objectLayer->getScaleY();
-//         auto pos = m_objectLayer->getPosition();
-
-//         m_objectLayer->setScale(1.f);
-//         m_objectLayer->setPosition({0.f, 0.f});
-
-//         for (auto& pair : m_effectManager->m_unkMap5c8) {
-//             for (auto obj : pair.second) {
-//                 obj->m_unkInt204 = m_gameState.m_unkUint2;
-//             }
-//         }
-
-//         size_t totalToRotate = asp::iter::from(m_effectManager->m_unkVector5b0)
-//             .filterMap([&](auto obj) -> std::optional<size_t> {
-//                 if (obj->m_unkInt204 != m_gameState.m_unkUint2 || obj->m_someInterpValue1RelatedFalse) {
-//                     return std::nullopt;
-//                 }
-
-//                 auto sgroup = this->getStaticGroup(obj->m_targetGroupID);
-//                 auto ogroup = this->getOptimizedGroup(obj->m_targetGroupID);
-
-//                 if (sgroup->data->num) {
-//                     ogroup = this->getGroup(obj->m_targetGroupID);
-//                 }
-
-//                 return ogroup->data->num;
-//             })
-//             .sum();
-
-//         bool shouldParallelize = totalToRotate > 1000;
-//         // log::debug("Rotating {} objects in total (parallel: {})", totalToRotate, shouldParallelize);
-
-//         auto p2 = Instant::now();
-
-//         if (shouldParallelize) {
-//             this->customPerformRotationsParallel();
-//         } else {
-//             this->customPerformRotations();
-//         }
-
-//         m_objectLayer->setScaleX(sx);
-//         m_objectLayer->setScaleY(sy);
-//         m_objectLayer->setPosition(pos);
-
-//         auto p3 = Instant::now();
-
-//         // log::debug(
-//         //     "Rotated {} objects (overhead: {}, rotating: {})",
-//         //     totalToRotate,
-//         //     p2.durationSince(p1).toString(),
-//         //     p3.durationSince(p2).toString()
-//         // );
-//     }
-
-//     void customPerformRotations() {
-//         for (auto& obj : m_effectManager->m_unkVector5b0) {
-//             if (obj->m_unkInt204 != m_gameState.m_unkUint2 || obj->m_someInterpValue1RelatedFalse) {
-//                 continue;
-//             }
-
-//             auto mainObj = this->tryGetMainObject(obj->m_centerGroupID);
-//             auto sgroup = this->getStaticGroup(obj->m_targetGroupID);
-//             auto ogroup = this->getOptimizedGroup(obj->m_targetGroupID);
-
-//             bool v17;
-//             double v18;
-
-//             if (sgroup->data->num) {
-//                 v17 = false;
-//                 ogroup = this->getGroup(obj->m_targetGroupID);
-//                 v18 = obj->m_someInterpValue1RelatedOne - obj->m_someInterpValue1RelatedZero;
-//             } else {
-//                 v17 = true;
-//                 v18 = obj->m_someInterpValue2RelatedOne - obj->m_someInterpValue2RelatedZero;
-//             }
-//             float v46 = v18;
-
-//             bool finishRelated = obj->m_finishRelated;
-//             if (v18 == 0.0 && !finishRelated) {
-//                 continue;
-//             }
-
-//             obj->m_someInterpValue1RelatedFalse = true;
-//             if (obj->m_lockObjectRotation) {
-//                 v18 = 0.0;
-//             }
-
-//             float v47 = v18;
-//             this->claimRotationAction(obj->m_targetGroupID, obj->m_centerGroupID, v46, v47, v17, true);
-
-//             if (mainObj) {
-//                 auto pos = mainObj->getUnmodifiedPosition();
-//                 auto claimed = this->claimMoveAction(obj->m_targetGroupID, v17);
-
-//                 m_areaTransformNode->setPosition(pos);
-//                 m_areaTransformNode->setScaleX(1.0f);
-//                 m_areaTransformNode->setScaleY(1.0f);
-//                 m_areaScaleNode->setScaleX(1.0f);
-//                 m_areaScaleNode->setScaleY(1.0f);
-//                 m_areaTransformNode->setSkewX(0.f);
-//                 m_areaTransformNode->setSkewY(0.f);
-//                 m_areaSkewNode->setSkewX(0.f);
-//                 m_areaSkewNode->setSkewY(0.f);
-//                 m_areaTransformNode->setRotation(v46);
-//                 this->prepareTransformParent(false);
-//                 auto t1 = m_areaTransformNode->nodeToWorldTransform();
-//                 auto t2 = m_areaSkewNode->nodeToWorldTransform();
-//                 auto t3 = m_areaScaleNode->nodeToWorldTransform();
-//                 m_areaTransformNode2->setScaleX(1.0f);
-//                 m_areaTransformNode2->setScaleY(1.0f);
-//                 m_areaTransformNode2->setSkewX(0.f);
-//                 m_areaTransformNode2->setSkewY(0.f);
-//                 m_rotatedCount += ogroup->data->num;
-
-//                 for (auto obj : CCArrayExt<GameObject>(ogroup)) {
-//                     obj->m_unk4fb = finishRelated;
-
-//                     if (!obj->m_isDecoration2) {
-//                         if (obj->m_unk4C4 != m_gameState.m_unkUint2) {
-//                             obj->m_lastPosition.x = obj->m_positionX;
-//                             obj->m_lastPosition.y = obj->m_positionY;
-//                             obj->m_unk4C4 = m_gameState.m_unkUint2;
-//                             obj->dirtifyObjectRect();
-//                         }
-//                     }
-
-//                     float xo = obj->m_positionXOffset;
-//                     float yo = obj->m_positionYOffset;
-//                     obj->m_isDirty = true;
-//                     obj->m_isUnmodifiedPosDirty = true;
-//                     float v32 = obj->m_positionX - xo - pos.x;
-//                     float v33 = obj->m_positionY - yo - pos.y;
-//                     auto tresult = __CCPointApplyAffineTransform({v32, v33}, t1);
-
-//                     obj->m_positionX = obj->m_positionXOffset + tresult.x + claimed.x;
-//                     obj->m_positionY = obj->m_positionYOffset + tresult.y + claimed.y;
-
-//                     if (v47 != 0.0 && obj->m_canRotateFree) {
-//                         obj->m_rotationXOffset += v47;
-//                         obj->m_rotationYOffset += v47;
-//                         this->customObjAddRotation(obj, v47);
-//                         if (obj->m_objectType != GameObjectType::Decoration && !obj->m_shouldUseOuterOb) {
-//                             obj->calculateOrientedBox();
-//                         }
-//                     }
-//                     this->updateObjectSection(obj);
-//                 }
-
-//                 this->updateDisabledObjectsLastPos(ogroup);
-//             } else if (ogroup && v47 != 0.0 && ogroup->data->num) {
-//                 m_rotatedCount += ogroup->data->num;
-
-//                 for (auto obj : CCArrayExt<GameObject>(ogroup)) {
-//                     if (obj->m_canRotateFree) {
-//                         obj->m_rotationXOffset += v47;
-//                         obj->m_rotationYOffset += v47;
-//                         this->customObjAddRotation(obj, v47);
-//                         if (obj->m_objectType != GameObjectType::Decoration) {
-//                             obj->m_isObjectRectDirty = true;
-//                             obj->m_isOrientedBoxDirty = true;
-//                             if (!obj->m_shouldUseOuterOb) {
-//                                 obj->calculateOrientedBox();
-//                             }
-//                         }
-//                     }
-//                 }
-//             }
-//         }
-//     }
-
-//     void customPerformRotationsParallel() {
-//         auto& pool = this->getPool();
-
-//         for (auto obj : m_effectManager->m_unkVector5b0) {
-//             if (obj->m_unkInt204 != m_gameState.m_unkUint2 || obj->m_someInterpValue1RelatedFalse) {
-//                 continue;
-//             }
-
-//             pool.pushTask([this, obj] {
-//                 auto mainObj = this->tryGetMainObject(obj->m_centerGroupID);
-//                 auto sgroup = this->customGetStaticGroup(obj->m_targetGroupID);
-//                 auto ogroup = this->customGetOptimizedGroup(obj->m_targetGroupID);
-
-//                 bool v17;
-//                 double v18;
-
-//                 if (sgroup->data->num) {
-//                     v17 = false;
-//                     ogroup = this->customGetGroup(obj->m_targetGroupID);
-//                     v18 = obj->m_someInterpValue1RelatedOne - obj->m_someInterpValue1RelatedZero;
-//                 } else {
-//                     v17 = true;
-//                     v18 = obj->m_someInterpValue2RelatedOne - obj->m_someInterpValue2RelatedZero;
-//                 }
-//                 float v46 = v18;
-
-//                 bool finishRelated = obj->m_finishRelated;
-//                 if (v18 == 0.0 && !finishRelated) {
-//                     return;
-//                 }
-
-//                 obj->m_someInterpValue1RelatedFalse = true;
-//                 if (obj->m_lockObjectRotation) {
-//                     v18 = 0.0;
-//                 }
-
-//                 float v47 = v18;
-//                 {
-//                     auto _g = g_raLock.lock();
-//                     this->claimRotationAction(obj->m_targetGroupID, obj->m_centerGroupID, v46, v47, v17, true);
-//                 }
-
-//                 if (mainObj) {
-//                     auto _lock = g_maLock.lock();
-
-//                     auto pos = mainObj->getUnmodifiedPosition();
-//                     auto claimed = this->claimMoveAction(obj->m_targetGroupID, v17);
-
-//                     m_areaTransformNode->setPosition(pos);
-//                     m_areaTransformNode->setScaleX(1.0f);
-//                     m_areaTransformNode->setScaleY(1.0f);
-//                     m_areaScaleNode->setScaleX(1.0f);
-//                     m_areaScaleNode->setScaleY(1.0f);
-//                     m_areaTransformNode->setSkewX(0.f);
-//                     m_areaTransformNode->setSkewY(0.f);
-//                     m_areaSkewNode->setSkewX(0.f);
-//                     m_areaSkewNode->setSkewY(0.f);
-//                     m_areaTransformNode->setRotation(v46);
-//                     this->prepareTransformParent(false);
-//                     auto t1 = m_areaTransformNode->nodeToWorldTransform();
-//                     auto t2 = m_areaSkewNode->nodeToWorldTransform();
-//                     auto t3 = m_areaScaleNode->nodeToWorldTransform();
-//                     m_areaTransformNode2->setScaleX(1.0f);
-//                     m_areaTransformNode2->setScaleY(1.0f);
-//                     m_areaTransformNode2->setSkewX(0.f);
-//                     m_areaTransformNode2->setSkewY(0.f);
-//                     m_rotatedCount += ogroup->data->num;
-
-//                     _lock.unlock();
-
-//                     for (auto obj : CCArrayExt<GameObject>(ogroup)) {
-//                         ObjectLockGuard _guard(obj);
-
-//                         obj->m_unk4fb = finishRelated;
-
-//                         if (!obj->m_isDecoration2) {
-//                             if (obj->m_unk4C4 != m_gameState.m_unkUint2) {
-//                                 obj->m_lastPosition.x = obj->m_positionX;
-//                                 obj->m_lastPosition.y = obj->m_positionY;
-//                                 obj->m_unk4C4 = m_gameState.m_unkUint2;
-//                                 obj->dirtifyObjectRect();
-//                             }
-//                         }
-
-//                         float xo = obj->m_positionXOffset;
-//                         float yo = obj->m_positionYOffset;
-//                         obj->m_isDirty = true;
-//                         obj->m_isUnmodifiedPosDirty = true;
-//                         float v32 = obj->m_positionX - xo - pos.x;
-//                         float v33 = obj->m_positionY - yo - pos.y;
-//                         auto tresult = __CCPointApplyAffineTransform({v32, v33}, t1);
-
-//                         obj->m_positionX = obj->m_positionXOffset + tresult.x + claimed.x;
-//                         obj->m_positionY = obj->m_positionYOffset + tresult.y + claimed.y;
-
-//                         if (v47 != 0.0 && obj->m_canRotateFree) {
-//                             obj->m_rotationXOffset += v47;
-//                             obj->m_rotationYOffset += v47;
-//                             this->customObjAddRotation(obj, v47);
-//                             if (obj->m_objectType != GameObjectType::Decoration && !obj->m_shouldUseOuterOb) {
-//                                 obj->calculateOrientedBox();
-//                             }
-//                         }
-//                         this->updateObjectSectionReimpl(obj);
-//                     }
-
-//                     this->updateDisabledObjectsLastPos(ogroup);
-//                 } else if (ogroup && v47 != 0.0 && ogroup->data->num) {
-//                     m_rotatedCount += ogroup->data->num;
-
-//                     for (auto obj : CCArrayExt<GameObject>(ogroup)) {
-//                         if (obj->m_canRotateFree) {
-//                             obj->m_rotationXOffset += v47;
-//                             obj->m_rotationYOffset += v47;
-//                             this->customObjAddRotation(obj, v47);
-//                             if (obj->m_objectType != GameObjectType::Decoration) {
-//                                 obj->m_isObjectRectDirty = true;
-//                                 obj->m_isOrientedBoxDirty = true;
-//                                 if (!obj->m_shouldUseOuterOb) {
-//                                     obj->calculateOrientedBox();
-//                                 }
-//                             }
-//                         }
-//                     }
-//                 }
-//             });
-//         }
-
-//         pool.join();
-//     }
-
-//     void customObjAddRotation(GameObject* obj, float r) {
-//         if (r == 0.0) return;
-
-//         // funny hack
-//         bool prd = obj->m_bRecursiveDirty;
-//         obj->m_bRecursiveDirty = true;
-
-//         if (obj->m_fRotationX == obj->m_fRotationY) {
-//             obj->setRotation(obj->m_fRotationX + r);
-//         } else {
-//             obj->setRotationX(obj->m_fRotationX + r);
-//             obj->setRotationY(obj->m_fRotationY + r);
-//         }
-
-//         obj->m_bRecursiveDirty = prd;
-//     }
-
-//     // -- Below: thread safe group reimpls --
-
-//     CCArray* customGetGroupWith(int id, gd::vector<CCArray*>& vec, CCDictionary* dict) {
-//         id = std::clamp(id, 0, 9999);
-//         auto group = vec[id]; // loads are atomic on most platforms so this is fine
-//         if (group) return group;
-
-//         auto _lock = g_groupLock.lock();
-//         group = vec[id]; // access again in case another thread just created it
-//         if (!group) {
-//             group = cocos2d::CCArray::create();
-//             dict->setObject(group, id);
-//             vec[id] = group;
-//         }
-
-//         return group;
-//     }
-
-//     CCArray* customGetStaticGroup(int id) {
-//         return this->customGetGroupWith(id, m_staticGroups, m_staticGroupDict);
-//     }
-
-//     CCArray* customGetOptimizedGroup(int id) {
-//         return this->customGetGroupWith(id, m_optimizedGroups, m_optimizedGroupDict);
-//     }
-
-//     CCArray* customGetGroup(int id) {
-//         return this->customGetGroupWith(id, m_groups, m_groupDict);
-//     }
-
-//     // -- Below: move reimpl --
-
-//     void processMoveActionsReimpl() {
-//         auto& vec = m_effectManager->m_unkVector708;
-
-//         // inline processMoveCalculations
-//         for (auto& action : vec) {
-//             float val = -action.m_gameObject->m_rotationXOffset * M_PI / 180.f;
-//             float cosine = cosf(val);
-//             float sine = sinf(val);
-//             float offx = action.m_offset.x;
-//             float offy = action.m_offset.y;
-
-//             CCPoint point;
-//             point.x = (offx * cosine - offy * sine) * (action.m_gameObject->m_scaleXOffset + 1.0f);
-//             point.y = (offy * cosine + offx * sine) * (action.m_gameObject->m_scaleYOffset + 1.0f);
-//             point -= action.m_offset;
-
-//             auto mn = action.m_moveNode;
-//             mn->m_unk0d1 = false;
-//             mn->m_unk038 += point.x;
-//             mn->m_unk040 += point.y;
-//             mn->m_unk090 += point.x;
-//             mn->m_unk098 += point.y;
-//         }
-//         vec.clear();
-
-//         struct ToProcess {
-//             CCMoveCNode* moveNode;
-//             CCArray* group;
-//             double offsetx;
-//             double offsety;
-//         };
-
-//         static std::vector<ToProcess> processLocally;
-//         size_t processingLocallyTotal = 0;
-//         bool anyInPool = false;
-//         processLocally.clear();
-
-//         auto& pool = this->getPool();
-
-//         auto enqueue = [&](CCMoveCNode* action, CCArray* group, double offsetx, double offsety) {
-//             size_t count = group->data->num;
-//             if (count == 0) return;
-
-//             if (count < 50 && processingLocallyTotal < 500) {
-//                 processLocally.push_back({action, group, offsetx, offsety});
-//                 processingLocallyTotal += count;
-//             } else if (count < 1000) {
-//                 // push to the thread pool directly
-//                 pool.pushTask([this, action, group, offsetx, offsety] {
-//                     this->moveObjectsReimpl<true>(group, offsetx, offsety, action->m_eObjType == CCObjectType::GameObject);
-//                 });
-//                 anyInPool = true;
-//             } else {
-//                 // huge amount of objects, split into chunks
-//                 size_t chunkSize = 500;
-//                 size_t chunks = (count + chunkSize - 1) / chunkSize;
-
-//                 for (size_t i = 0; i < chunks; i++) {
-//                     size_t startIdx = i * chunkSize;
-//                     size_t thisChunkSize = std::min(chunkSize, count - startIdx);
-
-//                     pool.pushTask([this, action, group, startIdx, thisChunkSize, offsetx, offsety] {
-//                         this->moveObjectsPartialCustom<true>(group, startIdx, thisChunkSize, offsetx, offsety, action->m_eObjType == CCObjectType::GameObject);
-//                     });
-//                 }
-//                 anyInPool = true;
-
-//                 // TODO: ideally we also want to call updateDisabledObjectsLastPos after all chunks are done,
-//                 // but this is unused in PlayLayer, and we don't support editor right now.
-//             }
-//         };
-
-//         for (auto action : m_effectManager->m_unkVector6c0) {
-//             if (action->m_unk0d0) continue;
-
-//             int tag = action->getTag();
-//             auto sgroup = this->customGetStaticGroup(tag);
-//             if (sgroup && (action->m_unk038 != 0.0 || action->m_unk040 != 0.0 || action->m_unk078)) {
-//                 enqueue(action, sgroup, action->m_unk038, action->m_unk040);
-//             }
-
-//             sgroup = this->customGetOptimizedGroup(tag);
-//             if (sgroup && (action->m_unk090 != 0.0 || action->m_unk098 != 0.0 || action->m_unk078)) {
-//                 enqueue(action, sgroup, action->m_unk090, action->m_unk098);
-//             }
-//         }
-
-//         // process small stuff here
-//         for (auto& item : processLocally) {
-//             // don't do any locking if everything was done on main
-//             if (anyInPool) {
-//                 this->moveObjectsReimpl<true>(
-//                     item.group,
-//                     item.offsetx,
-//                     item.offsety,
-//                     item.moveNode->m_eObjType == CCObjectType::GameObject
-//                 );
-//             } else {
-//                 this->moveObjectsReimpl<false>(
-//                     item.group,
-//                     item.offsetx,
-//                     item.offsety,
-//                     item.moveNode->m_eObjType == CCObjectType::GameObject
-//                 );
-//             }
-//         }
-
-//         // wait for the rest
-//         pool.join();
-//     }
-
-//     template <bool DoLock = true>
-//     void moveObjectsReimpl(CCArray* arr, double offsetx, double offsety, bool p3) {
-//         int count = arr->data->num;
-//         if (count == 0) return;
-
-//         this->moveObjectsPartialCustom<DoLock>(arr, 0, count, offsetx, offsety, p3);
-//         this->updateDisabledObjectsLastPos(arr);
-//     }
-
-//     template <bool DoLock>
-//     void moveObjectsPartialCustom(CCArray* arr, size_t startIdx, size_t count, double offsetx, double offsety, bool p3) {
-//         // log::debug("Moving {} objects with p1 = {}, p2 = {}, p3 = {}", count, offsetx, offsety, p3);
-
-//         reinterpret_cast<std::atomic_int*>(&m_movedCount)->fetch_add(count, std::memory_order_relaxed);
-
-//         for (size_t i = startIdx; i < startIdx + count; i++) {
-//             auto obj = static_cast<GameObject*>(arr->data->arr[i]);
-
-//             std::conditional_t<DoLock, ObjectLockGuard, void*> _guard{obj};
-
-//             if (!obj->m_isDecoration2 && obj->m_unk4C4 != m_gameState.m_unkUint2) {
-//                 obj->m_lastPosition.x = obj->m_positionX;
-//                 obj->m_lastPosition.y = obj->m_positionY;
-//                 obj->m_unk4C4 = m_gameState.m_unkUint2;
-//                 obj->dirtifyObjectRect();
-//             }
-
-//             if (offsetx != 0.0 && !obj->m_tempOffsetXRelated) {
-//                 obj->m_positionX += offsetx;
-//             }
-
-//             if (offsety != 0.0) {
-//                 obj->m_positionY += offsety;
-//             }
-
-//             obj->dirtifyObjectPos();
-
-//             this->updateObjectSectionReimpl(obj);
-//         }
-//     }
-
-//     template <bool DoLock = true>
-//     void updateObjectSectionReimpl(GameObject* obj) {
-//         if (obj->m_outerSectionIndex < 0) return;
-
-//         double posx = obj->m_positionX;
-//         if (posx <= 0.0) {
-//             posx = 0.0;
-//         } else {
-//             if (posx < 1000000.0) {
-//                 posx = (double)m_sectionXFactor * posx;
-//             } else {
-//                 posx = (double)m_sectionXFactor * 1000000.0;
-//             }
-//         }
-
-//         double posy = obj->m_positionY;
-//         if (posy <= 0.0) {
-//             posy = 0.0;
-//         } else {
-//             if (posy < 1000000.0) {
-//                 posy = (double)m_sectionYFactor * posy;
-//             } else {
-//                 posy = (double)m_sectionYFactor * 1000000.0;
-//             }
-//         }
-
-//         if ((int)posx != obj->m_outerSectionIndex || (int)posy != obj->m_middleSectionIndex) {
-//             auto _lock = this->_lockSections<DoLock>();
-
-//             // inline reorderObjectSection (2 calls)
-//             this->removeObjectFromSection(obj);
-//             this->addToSection(obj);
-
-//             if (obj->m_isActivated) {
-//                 int outer = obj->m_outerSectionIndex;
-//                 int middle = obj->m_middleSectionIndex;
-
-//                 if (outer > m_rightSectionIndex || outer < m_leftSectionIndex || middle < m_bottomSectionIndex || middle > m_topSectionIndex) {
-//                     m_objectsToDeactivate->setObject(obj, obj->m_uniqueID);
-//                     obj->m_unk3ee = true;
-//                 }
-//             }
-//         }
-//     }
-
-//     template <bool Lock>
-//     auto _lockSections();
-
-//     template <>
-//     auto _lockSections<true>() {
-//         return g_sectionLock.lock();
-//     }
-
-//     template <>
-//     auto _lockSections<false>() {
-//         return 0;
-//     }
-// };
-
-// class $modify(PlayLayer) {
-//     void setupHasCompleted() {
-//         PlayLayer::setupHasCompleted();
-
-//         auto gjbgl = reinterpret_cast<ParallelGJBGL*>(this);
-//         for (auto obj : CCArrayExt<GameObject>(gjbgl->m_objects)) {
-//             // initialize locks
-//             getObjectLock(obj).store(0, std::memory_order_relaxed);
-//         }
-//     }
-// };
-
-// }
+#include <Geode/Geode.hpp>
+#include <Geode/modify/GJBaseGameLayer.hpp>
+#include <Geode/modify/PlayLayer.hpp>
+
+#include <algo/transform.hpp>
+#include <settings.hpp>
+#include <tracing.hpp>
+#include <util/hash.hpp>
+#include <util/parallel.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "GJBaseGameLayer.hpp"
+
+// Parallel rotation and move triggers.
+//
+// Triggers are still handled one at a time in the game's order, along with everything that touches shared state
+// (claiming actions, the area transform nodes, counters), but the objects of large groups are transformed on multiple threads.
+// An object is only ever in a group once, and its new transform only depends on its own state and on values computed
+// beforehand for the whole trigger, so this gives the exact same results as a plain loop. An object that is in several
+// moved groups is still moved in the same order, since every group is finished before the next one starts.
+// The two things that are not safe off the main thread, moving an object to another section and creating its oriented box
+// for the first time (which autoreleases it), are done right after each group on the main thread, in the original order.
+// Rotated positions are additionally computed in batches with SIMD (see algo/transform), which is bit-exact as well.
+
+using namespace geode::prelude;
+
+namespace blaze {
+
+// Ticks that rotate fewer objects than this in total are left to the game, splitting them up isn't worth it.
+static constexpr size_t PARALLEL_ROTATION_THRESHOLD = 1000;
+static constexpr size_t ROTATION_BATCH_SIZE = 128;
+
+// Moving is a lot cheaper per object than rotating, so only really big groups are split up.
+static constexpr size_t PARALLEL_MOVE_THRESHOLD = 2048;
+static constexpr size_t MOVE_BATCH_SIZE = 512;
+
+// Positions of a batch of rotated objects, copied out into separate arrays so that `rotatePositions` can use SIMD.
+// The game's math is reproduced exactly only because positions and offsets are doubles, rounded to floats in specific places.
+static_assert(std::is_same_v<decltype(GameObject::m_positionX), double> && std::is_same_v<decltype(GameObject::m_positionXOffset), double>);
+static_assert(std::is_same_v<decltype(GameObject::m_positionY), double> && std::is_same_v<decltype(GameObject::m_positionYOffset), double>);
+
+struct PositionBatch {
+    std::vector<double> x, y, offsetX, offsetY;
+
+    void resize(size_t count) {
+        x.resize(count);
+        y.resize(count);
+        offsetX.resize(count);
+        offsetY.resize(count);
+    }
+};
+
+#ifdef BLAZE_DEBUG
+// Replay check, armed from the debug menu. The next attempt is played with vanilla triggers while a hash of every object's
+// transform (and the dirty flags of its sprites) is recorded after each tick, then every following attempt uses the parallel
+// engines (regardless of the thresholds) and is compared against the recording tick by tick.
+// Play without input, or with a bot, so that every attempt takes the same path.
+namespace {
+    struct TriggerReplay {
+        enum class State { Idle, Armed, Recording, Verifying };
+
+        State state = State::Idle;
+        std::vector<uint64_t> hashes;
+        size_t tick = 0;
+        size_t mismatches = 0;
+
+        void onAttempt() {
+            if (state == State::Verifying) {
+                this->report();
+            } else if (state == State::Recording) {
+                log::info("Trigger replay: recorded {} ticks, verifying from now on", hashes.size());
+                state = State::Verifying;
+            } else if (state == State::Armed) {
+                state = State::Recording;
+                hashes.clear();
+            }
+
+            tick = 0;
+            mismatches = 0;
+        }
+
+        void report() {
+            if (tick == 0) return;
+
+            if (mismatches == 0) {
+                log::info("Trigger replay: {} ticks match vanilla", std::min(tick, hashes.size()));
+            } else {
+                log::error("Trigger replay: {} of {} ticks differ from vanilla", mismatches, std::min(tick, hashes.size()));
+            }
+        }
+
+        void onTick(GJBaseGameLayer* layer) {
+            if (state != State::Recording && state != State::Verifying) return;
+
+            uint64_t hash = FNV_OFFSET_BASIS_64;
+            auto mix = [&](auto value) {
+                hash = (hash ^ std::bit_cast<std::conditional_t<sizeof(value) == 8, uint64_t, uint32_t>>(value)) * FNV_PRIME_64;
+            };
+
+            for (auto obj : CCArrayExt<GameObject>(layer->m_objects)) {
+                mix(obj->m_positionX);
+                mix(obj->m_positionY);
+                mix(obj->getRotationX());
+                mix(obj->getRotationY());
+                mix(obj->m_outerSectionIndex);
+                mix(obj->m_middleSectionIndex);
+
+                // rotating marks the sprite and its children dirty for the next draw
+                mix((uint32_t)obj->isDirty() | ((uint32_t)obj->m_bRecursiveDirty << 1));
+                for (auto child : CCArrayExt<CCNode>(obj->getChildren())) {
+                    if (auto sprite = typeinfo_cast<CCSprite*>(child)) {
+                        mix((uint32_t)sprite->isDirty() | ((uint32_t)sprite->m_bRecursiveDirty << 1));
+                    }
+                }
+            }
+
+            if (state == State::Recording) {
+                hashes.push_back(hash);
+            } else if (tick < hashes.size() && hashes[tick] != hash) {
+                if (mismatches++ == 0) {
+                    log::error("Trigger replay: first mismatch at tick {}", tick);
+                }
+            }
+
+            tick++;
+        }
+
+        bool isActive() const {
+            return state == State::Recording || state == State::Verifying;
+        }
+
+        void override(bool& enabled, size_t& threshold, bool editor) const {
+            if (state == State::Recording) {
+                enabled = false;
+            } else if (state == State::Verifying && !editor) {
+                enabled = true;
+                threshold = 0;
+            }
+        }
+    };
+
+    TriggerReplay s_replay;
+}
+
+void armTriggerReplayCheck() {
+    s_replay.state = TriggerReplay::State::Armed;
+    log::info("Trigger replay: armed, start a trigger heavy level and let it restart a few times");
+}
+#endif
+
+struct SectionIndex {
+    int outer;
+    int middle;
+};
+
+// The section that updateObjectSection would put the object in. Doesn't touch anything outside of the object.
+static SectionIndex targetSection(GJBaseGameLayer* layer, GameObject* obj) {
+    double posx = obj->m_positionX;
+    if (posx <= 0.0) {
+        posx = 0.0;
+    } else {
+        if (posx < 1000000.0) {
+            posx = (double)layer->m_sectionXFactor * posx;
+        } else {
+            posx = (double)layer->m_sectionXFactor * 1000000.0;
+        }
+    }
+
+    double posy = obj->m_positionY;
+    if (posy <= 0.0) {
+        posy = 0.0;
+    } else {
+        if (posy < 1000000.0) {
+            posy = (double)layer->m_sectionYFactor * posy;
+        } else {
+            posy = (double)layer->m_sectionYFactor * 1000000.0;
+        }
+    }
+
+    return {(int)posx, (int)posy};
+}
+
+// Whether updateObjectSection would move the object to another section, it does nothing otherwise.
+static bool isInWrongSection(GJBaseGameLayer* layer, GameObject* obj) {
+    if (obj->m_outerSectionIndex < 0) return false;
+
+    auto target = targetSection(layer, obj);
+    return target.outer != obj->m_outerSectionIndex || target.middle != obj->m_middleSectionIndex;
+}
+
+struct ParallelRotationGJBGL : Modify<ParallelRotationGJBGL, GJBaseGameLayer> {
+    $override
+    void processRotationActions() {
+        ZoneScoped;
+
+        bool enabled = blaze::settings().parallelRotations && !m_isEditor;
+        size_t threshold = PARALLEL_ROTATION_THRESHOLD;
+
+#ifdef BLAZE_DEBUG
+        s_replay.override(enabled, threshold, m_isEditor);
+#endif
+
+        if (!enabled) {
+            return GJBaseGameLayer::processRotationActions();
+        }
+
+        for (auto& pair : m_effectManager->m_unkMap5c8) {
+            for (auto obj : pair.second) {
+                obj->m_unkInt204 = m_gameState.m_unkUint2;
+            }
+        }
+
+        if (this->countObjectsToRotate() < threshold) {
+            return GJBaseGameLayer::processRotationActions();
+        }
+
+        float sx = m_objectLayer->getScaleX();
+        float sy = m_objectLayer->getScaleY();
+        auto pos = m_objectLayer->getPosition();
+
+        m_objectLayer->setScale(1.f);
+        m_objectLayer->setPosition({0.f, 0.f});
+
+        this->performRotations();
+
+        m_objectLayer->setScaleX(sx);
+        m_objectLayer->setScaleY(sy);
+        m_objectLayer->setPosition(pos);
+    }
+
+    bool isPendingRotation(EffectGameObject* obj) {
+        return obj->m_unkInt204 == m_gameState.m_unkUint2 && !obj->m_someInterpValue1RelatedFalse;
+    }
+
+    size_t countObjectsToRotate() {
+        size_t total = 0;
+
+        for (auto obj : m_effectManager->m_unkVector5b0) {
+            if (!this->isPendingRotation(obj)) continue;
+
+            auto sgroup = this->getStaticGroup(obj->m_targetGroupID);
+            auto ogroup = this->getOptimizedGroup(obj->m_targetGroupID);
+
+            if (sgroup->data->num) {
+                ogroup = this->getGroup(obj->m_targetGroupID);
+            }
+
+            total += ogroup->data->num;
+        }
+
+        return total;
+    }
+
+    void performRotations() {
+        for (auto obj : m_effectManager->m_unkVector5b0) {
+            if (!this->isPendingRotation(obj)) continue;
+
+            auto mainObj = this->tryGetMainObject(obj->m_centerGroupID);
+            auto sgroup = this->getStaticGroup(obj->m_targetGroupID);
+            auto ogroup = this->getOptimizedGroup(obj->m_targetGroupID);
+
+            bool v17;
+            double v18;
+
+            if (sgroup->data->num) {
+                v17 = false;
+                ogroup = this->getGroup(obj->m_targetGroupID);
+                v18 = obj->m_someInterpValue1RelatedOne - obj->m_someInterpValue1RelatedZero;
+            } else {
+                v17 = true;
+                v18 = obj->m_someInterpValue2RelatedOne - obj->m_someInterpValue2RelatedZero;
+            }
+            float v46 = v18;
+
+            bool finishRelated = obj->m_finishRelated;
+            if (v18 == 0.0 && !finishRelated) {
+                continue;
+            }
+
+            obj->m_someInterpValue1RelatedFalse = true;
+            if (obj->m_lockObjectRotation) {
+                v18 = 0.0;
+            }
+
+            float v47 = v18;
+            this->claimRotationAction(obj->m_targetGroupID, obj->m_centerGroupID, v46, v47, v17, true);
+
+            if (mainObj) {
+                auto pos = mainObj->getUnmodifiedPosition();
+                auto claimed = this->claimMoveAction(obj->m_targetGroupID, v17);
+
+                m_areaTransformNode->setPosition(pos);
+                m_areaTransformNode->setScaleX(1.0f);
+                m_areaTransformNode->setScaleY(1.0f);
+                m_areaScaleNode->setScaleX(1.0f);
+                m_areaScaleNode->setScaleY(1.0f);
+                m_areaTransformNode->setSkewX(0.f);
+                m_areaTransformNode->setSkewY(0.f);
+                m_areaSkewNode->setSkewX(0.f);
+                m_areaSkewNode->setSkewY(0.f);
+                m_areaTransformNode->setRotation(v46);
+                this->prepareTransformParent(false);
+                auto transform = m_areaTransformNode->nodeToWorldTransform();
+                // not used, but they update the cached transforms of the nodes like the game does
+                (void) m_areaSkewNode->nodeToWorldTransform();
+                (void) m_areaScaleNode->nodeToWorldTransform();
+                m_areaTransformNode2->setScaleX(1.0f);
+                m_areaTransformNode2->setScaleY(1.0f);
+                m_areaTransformNode2->setSkewX(0.f);
+                m_areaTransformNode2->setSkewY(0.f);
+                m_rotatedCount += ogroup->data->num;
+
+                RotationTransform rt{
+                    transform.a, transform.b, transform.c, transform.d, transform.tx, transform.ty,
+                    pos.x, pos.y, claimed.x, claimed.y
+                };
+
+                this->forEachBatch(ogroup, [&](GameObject** objects, size_t count, uint8_t* needsBox) {
+                    thread_local PositionBatch batch;
+                    batch.resize(count);
+
+                    for (size_t i = 0; i < count; i++) {
+                        auto obj = objects[i];
+                        obj->m_unk4fb = finishRelated;
+
+                        if (!obj->m_isDecoration2) {
+                            if (obj->m_unk4C4 != m_gameState.m_unkUint2) {
+                                obj->m_lastPosition.x = obj->m_positionX;
+                                obj->m_lastPosition.y = obj->m_positionY;
+                                obj->m_unk4C4 = m_gameState.m_unkUint2;
+                                obj->dirtifyObjectRect();
+                            }
+                        }
+
+                        obj->m_isDirty = true;
+                        obj->m_isUnmodifiedPosDirty = true;
+
+                        batch.x[i] = obj->m_positionX;
+                        batch.y[i] = obj->m_positionY;
+                        batch.offsetX[i] = obj->m_positionXOffset;
+                        batch.offsetY[i] = obj->m_positionYOffset;
+                    }
+
+                    rotatePositions(batch.x.data(), batch.y.data(), batch.offsetX.data(), batch.offsetY.data(), count, rt);
+
+                    for (size_t i = 0; i < count; i++) {
+                        auto obj = objects[i];
+                        obj->m_positionX = batch.x[i];
+                        obj->m_positionY = batch.y[i];
+                        needsBox[i] = false;
+
+                        if (v47 != 0.0 && obj->m_canRotateFree) {
+                            obj->m_rotationXOffset += v47;
+                            obj->m_rotationYOffset += v47;
+                            obj->addRotation(v47);
+                            if (obj->m_objectType != GameObjectType::Decoration && !obj->m_shouldUseOuterOb) {
+                                needsBox[i] = this->tryCalculateOrientedBox(obj);
+                            }
+                        }
+                    }
+                }, [&](GameObject* obj, bool needsBox) {
+                    if (needsBox) obj->calculateOrientedBox();
+                    this->updateObjectSection(obj);
+                });
+
+                this->updateDisabledObjectsLastPos(ogroup);
+            } else if (ogroup && v47 != 0.0 && ogroup->data->num) {
+                m_rotatedCount += ogroup->data->num;
+
+                this->forEachObject(ogroup, [&](GameObject* obj) {
+                    if (obj->m_canRotateFree) {
+                        obj->m_rotationXOffset += v47;
+                        obj->m_rotationYOffset += v47;
+                        obj->addRotation(v47);
+                        if (obj->m_objectType != GameObjectType::Decoration) {
+                            obj->m_isObjectRectDirty = true;
+                            obj->m_isOrientedBoxDirty = true;
+                            if (!obj->m_shouldUseOuterOb) {
+                                return this->tryCalculateOrientedBox(obj);
+                            }
+                        }
+                    }
+
+                    return false;
+                }, [&](GameObject* obj, bool needsBox) {
+                    if (needsBox) obj->calculateOrientedBox();
+                });
+            }
+        }
+    }
+
+    // Runs `transform` for every object in the group, in parallel for big groups, then `finish` for every object
+    // on this thread in order. `transform` returns whether the object still needs its oriented box calculated.
+    template <typename Transform, typename Finish>
+    void forEachObject(CCArray* group, Transform&& transform, Finish&& finish) {
+        this->forEachBatch(group, [&](GameObject** objects, size_t count, uint8_t* needsBox) {
+            for (size_t i = 0; i < count; i++) {
+                needsBox[i] = transform(objects[i]);
+            }
+        }, std::forward<Finish>(finish));
+    }
+
+    // Same as `forEachObject`, but `transform` gets a whole batch of objects at once and fills in `needsBox` for each.
+    template <typename Transform, typename Finish>
+    void forEachBatch(CCArray* group, Transform&& transform, Finish&& finish) {
+        static std::vector<uint8_t> needsBox;
+
+        size_t count = group->data->num;
+        auto objects = reinterpret_cast<GameObject**>(group->data->arr);
+
+        needsBox.resize(count);
+
+        WorkerGroup::get().parallelFor(count, ROTATION_BATCH_SIZE, [&](size_t begin, size_t end) {
+            transform(objects + begin, end - begin, needsBox.data() + begin);
+        });
+
+        for (size_t i = 0; i < count; i++) {
+            finish(objects[i], needsBox[i] != 0);
+        }
+    }
+
+    // The oriented box is allocated the first time it's calculated, which has to happen on the main thread.
+    static bool tryCalculateOrientedBox(GameObject* obj) {
+        if (!obj->m_orientedBox) return true;
+
+        obj->calculateOrientedBox();
+        return false;
+    }
+};
+
+struct ParallelMoveGJBGL : Modify<ParallelMoveGJBGL, GJBaseGameLayer> {
+    $override
+    void moveObjects(CCArray* objects, double offsetx, double offsety, bool p3) {
+        size_t count = objects ? objects->count() : 0;
+
+        bool enabled = blaze::settings().parallelMoves && !m_isEditor;
+        size_t threshold = PARALLEL_MOVE_THRESHOLD;
+
+#ifdef BLAZE_DEBUG
+        s_replay.override(enabled, threshold, m_isEditor);
+#endif
+
+        if (!enabled || count == 0 || count < threshold) {
+            return GJBaseGameLayer::moveObjects(objects, offsetx, offsety, p3);
+        }
+
+        ZoneScoped;
+
+        static std::vector<uint8_t> sectionChanged;
+
+        m_movedCount += count;
+
+        auto arr = reinterpret_cast<GameObject**>(objects->data->arr);
+        sectionChanged.resize(count);
+
+        WorkerGroup::get().parallelFor(count, MOVE_BATCH_SIZE, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                auto obj = arr[i];
+
+                if (!obj->m_isDecoration2 && obj->m_unk4C4 != m_gameState.m_unkUint2) {
+                    obj->m_lastPosition.x = obj->m_positionX;
+                    obj->m_lastPosition.y = obj->m_positionY;
+                    obj->m_unk4C4 = m_gameState.m_unkUint2;
+                    obj->dirtifyObjectRect();
+                }
+
+                if (offsetx != 0.0 && !obj->m_tempOffsetXRelated) {
+                    obj->m_positionX += offsetx;
+                }
+
+                if (offsety != 0.0) {
+                    obj->m_positionY += offsety;
+                }
+
+                obj->dirtifyObjectPos();
+
+                sectionChanged[i] = isInWrongSection(this, obj);
+            }
+        });
+
+        // updateObjectSection does nothing for objects that stay in their section,
+        // so it only has to be called (in the original order) for the ones that leave it
+        for (size_t i = 0; i < count; i++) {
+            if (sectionChanged[i]) {
+                this->updateObjectSection(arr[i]);
+            }
+        }
+
+        this->updateDisabledObjectsLastPos(objects);
+    }
+};
+
+// Deferred section updates.
+//
+// During the move step, updateObjectSection only notes down objects that ended up outside of their section, and once the
+// step is done they are all moved in one pass: each section that objects leave is compacted once, and each section they
+// enter gets all of them appended at once, instead of an erase and an insert for every object.
+// A section holds the first `m_sectionSizes[outer][middle]` objects of its vector, in order, same as what
+// removeObjectFromSection and addToSection maintain. Objects leaving or entering a section that doesn't exist yet
+// go through updateObjectSection, which creates it.
+// An object that crosses several sections in one tick is then only moved once, and one that comes back to where it started
+// isn't moved at all. Unlike the parallel engines this is not exactly vanilla: such an object can end up at a different
+// index within its section, and it's no longer deactivated for passing through a section outside of the screen.
+// Nothing in the step itself looks at the sections, everything that does (visibility, collisions) runs after it.
+
+static bool s_deferSections = false;
+static std::vector<GameObject*> s_dirtySections;
+
+namespace {
+    struct SectionMove {
+        GameObject* obj;
+        uint64_t from, to;
+    };
+
+    struct SectionRef {
+        gd::vector<GameObject*>* objects = nullptr;
+        int* size = nullptr;
+    };
+}
+
+static uint64_t sectionKey(int outer, int middle) {
+    return (uint64_t)(uint32_t)outer << 32 | (uint32_t)middle;
+}
+
+struct DeferredSectionGJBGL : Modify<DeferredSectionGJBGL, GJBaseGameLayer> {
+    $override
+    void processMoveActionsStep(float dt, bool p1) {
+        bool enabled = blaze::settings().deferredSections && !m_isEditor;
+
+#ifdef BLAZE_DEBUG
+        // not exact, so it would make the replay check fail for reasons that have nothing to do with the parallel engines
+        if (s_replay.isActive()) {
+            enabled = false;
+        }
+#endif
+
+        if (enabled) {
+            s_deferSections = true;
+            GJBaseGameLayer::processMoveActionsStep(dt, p1);
+            s_deferSections = false;
+
+            this->flushObjectSections();
+        } else {
+            GJBaseGameLayer::processMoveActionsStep(dt, p1);
+        }
+
+#ifdef BLAZE_DEBUG
+        s_replay.onTick(this);
+#endif
+    }
+
+    $override
+    void updateObjectSection(GameObject* obj) {
+        if (!s_deferSections) {
+            return GJBaseGameLayer::updateObjectSection(obj);
+        }
+
+        // the same object can be noted multiple times, updating it again once it's in the right section does nothing
+        if (isInWrongSection(this, obj)) {
+            s_dirtySections.push_back(obj);
+        }
+    }
+
+    void flushObjectSections() {
+        if (s_dirtySections.empty()) return;
+
+        ZoneScoped;
+
+        static std::vector<SectionMove> moves;
+        static std::vector<GameObject*> fallback;
+        static std::unordered_set<GameObject*> seen;
+        static std::vector<GameObject*> leaving;
+        moves.clear();
+        fallback.clear();
+        seen.clear();
+
+        for (auto obj : s_dirtySections) {
+            if (!isInWrongSection(this, obj) || !seen.insert(obj).second) continue;
+
+            auto target = targetSection(this, obj);
+            if (!this->findSection(obj->m_outerSectionIndex, obj->m_middleSectionIndex).objects
+                || !this->findSection(target.outer, target.middle).objects)
+            {
+                fallback.push_back(obj);
+                continue;
+            }
+
+            moves.push_back({
+                obj,
+                sectionKey(obj->m_outerSectionIndex, obj->m_middleSectionIndex),
+                sectionKey(target.outer, target.middle)
+            });
+        }
+
+        // stable, so that objects enter their new sections in the order they were noted in
+        std::stable_sort(moves.begin(), moves.end(), [](auto& a, auto& b) { return a.from < b.from; });
+
+        for (size_t i = 0; i < moves.size();) {
+            size_t end = i;
+            leaving.clear();
+            while (end < moves.size() && moves[end].from == moves[i].from) {
+                leaving.push_back(moves[end++].obj);
+            }
+
+            std::sort(leaving.begin(), leaving.end());
+            this->removeFromSection(moves[i].from, leaving);
+            i = end;
+        }
+
+        std::stable_sort(moves.begin(), moves.end(), [](auto& a, auto& b) { return a.to < b.to; });
+
+        for (size_t i = 0; i < moves.size();) {
+            size_t end = i;
+            while (end < moves.size() && moves[end].to == moves[i].to) end++;
+
+            this->appendToSection(moves[i].to, moves.data() + i, end - i);
+            i = end;
+        }
+
+        for (auto obj : fallback) {
+            GJBaseGameLayer::updateObjectSection(obj);
+        }
+
+        s_dirtySections.clear();
+    }
+
+    // The section's vector and object count, or nulls if the game hasn't created the section.
+    SectionRef findSection(int outer, int middle) {
+        if (outer < 0 || (size_t)outer >= m_sections.size() || (size_t)outer >= m_sectionSizes.size()) return {};
+
+        auto column = m_sections[outer];
+        auto sizes = m_sectionSizes[outer];
+        if (!column || !sizes || middle < 0 || (size_t)middle >= column->size() || (size_t)middle >= sizes->size()) return {};
+
+        auto objects = (*column)[middle];
+        if (!objects) return {};
+
+        return {objects, &(*sizes)[middle]};
+    }
+
+    // Removes the objects in `leaving` (sorted) from the section, keeping the order of the rest.
+    void removeFromSection(uint64_t key, const std::vector<GameObject*>& leaving) {
+        auto section = this->findSection((int)(key >> 32), (int)(uint32_t)key);
+        auto objects = section.objects->data();
+        int size = std::min(*section.size, (int)section.objects->size());
+
+        int kept = 0;
+        for (int i = 0; i < size; i++) {
+            if (!std::binary_search(leaving.begin(), leaving.end(), objects[i])) {
+                objects[kept++] = objects[i];
+            }
+        }
+
+        *section.size = kept;
+    }
+
+    void appendToSection(uint64_t key, const SectionMove* moves, size_t count) {
+        int outer = (int)(key >> 32);
+        int middle = (int)(uint32_t)key;
+
+        auto section = this->findSection(outer, middle);
+        auto& objects = *section.objects;
+
+        // sections that receive objects on every tick keep growing geometrically
+        size_t needed = (size_t)*section.size + count;
+        if (objects.capacity() < needed) {
+            objects.reserve(std::max(needed, objects.capacity() * 2));
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            auto obj = moves[i].obj;
+
+            if ((size_t)*section.size < objects.size()) {
+                objects[*section.size] = obj;
+            } else {
+                objects.push_back(obj);
+            }
+
+            (*section.size)++;
+            obj->m_outerSectionIndex = outer;
+            obj->m_middleSectionIndex = middle;
+
+            // same as updateObjectSection
+            if (obj->m_isActivated
+                && (outer > m_rightSectionIndex || outer < m_leftSectionIndex || middle < m_bottomSectionIndex || middle > m_topSectionIndex))
+            {
+                m_objectsToDeactivate->setObject(obj, obj->m_uniqueID);
+                obj->m_unk3ee = true;
+            }
+        }
+    }
+};
+
+// Collision broadphase.
+//
+// checkCollisions hands every object of the sections around a player to collisionCheckObjects, which tests them one by one,
+// reading each object's rect from a different place in memory. Here the bounds of every section's objects are cached in
+// contiguous arrays, and only the objects that can overlap the player are passed on, in their original order.
+// Only objects whose rect never changes are ever skipped: objects without groups, which no trigger can move, rotate, scale
+// or toggle, and which are not animated or rotating on their own (those are all `EnhancedGameObject`s). Their cached bounds
+// are a circle around the object's position, which its rect rotates around, so they stay valid even if the rect is rotated.
+// Every other object gets infinite bounds and is always passed on.
+// Rather than relying on every place that moves objects between sections, a section's cache keeps a copy of the section's
+// contents and is rebuilt whenever they differ, which only costs a comparison of the object pointers.
+
+// Sections with fewer objects than this are passed on as is.
+static constexpr int BROADPHASE_MIN_OBJECTS = 32;
+// Added around the player's rect. The game tests some objects with slightly bigger rects than their own, and the player
+// can be scaled or moved right before the check.
+static constexpr float BROADPHASE_MARGIN = 60.f;
+
+namespace {
+    struct SectionBounds {
+        // contents of the section when the bounds were calculated
+        std::vector<GameObject*> objects;
+        std::vector<float> minX, minY, maxX, maxY;
+    };
+
+    GJBaseGameLayer* s_boundsLayer = nullptr;
+    std::unordered_map<const gd::vector<GameObject*>*, SectionBounds> s_sectionBounds;
+}
+
+struct CollisionBroadphaseGJBGL : Modify<CollisionBroadphaseGJBGL, GJBaseGameLayer> {
+    $override
+    void collisionCheckObjects(PlayerObject* player, gd::vector<GameObject*>* objects, int count, float dt) {
+        static gd::vector<GameObject*> candidates;
+        static bool inUse = false;
+
+        if (!blaze::settings().collisionBroadphase || m_isEditor || inUse || !objects || count < BROADPHASE_MIN_OBJECTS) {
+            return GJBaseGameLayer::collisionCheckObjects(player, objects, count, dt);
+        }
+
+        ZoneScoped;
+
+        if (s_boundsLayer != this) {
+            s_sectionBounds.clear();
+            s_boundsLayer = this;
+        }
+
+        auto& bounds = this->boundsForSection(objects, count);
+
+        auto rect = player->getObjectRect();
+        auto pos = player->getPosition();
+        float moveX = pos.x - player->m_lastPosition.x;
+        float moveY = pos.y - player->m_lastPosition.y;
+
+        float qMinX = rect.getMinX() - std::abs(moveX) - BROADPHASE_MARGIN;
+        float qMaxX = rect.getMaxX() + std::abs(moveX) + BROADPHASE_MARGIN;
+        float qMinY = rect.getMinY() - std::abs(moveY) - BROADPHASE_MARGIN;
+        float qMaxY = rect.getMaxY() + std::abs(moveY) + BROADPHASE_MARGIN;
+
+        candidates.clear();
+
+        for (int i = 0; i < count; i++) {
+            if (bounds.maxX[i] >= qMinX && bounds.minX[i] <= qMaxX && bounds.maxY[i] >= qMinY && bounds.minY[i] <= qMaxY) {
+                candidates.push_back(bounds.objects[i]);
+            }
+        }
+
+#ifdef BLAZE_DEBUG
+        this->verifySkippedObjects(player, bounds, qMinX, qMaxX, qMinY, qMaxY);
+#endif
+
+        if (candidates.size() == (size_t)count) {
+            return GJBaseGameLayer::collisionCheckObjects(player, objects, count, dt);
+        }
+
+        inUse = true;
+        GJBaseGameLayer::collisionCheckObjects(player, &candidates, (int)candidates.size(), dt);
+        inUse = false;
+    }
+
+    static bool hasStaticRect(GameObject* obj) {
+        return obj->m_groupCount == 0 && !typeinfo_cast<EnhancedGameObject*>(obj);
+    }
+
+    SectionBounds& boundsForSection(gd::vector<GameObject*>* objects, int count) {
+        auto& bounds = s_sectionBounds[objects];
+
+        if (bounds.objects.size() == (size_t)count
+            && std::memcmp(bounds.objects.data(), objects->data(), count * sizeof(GameObject*)) == 0)
+        {
+            return bounds;
+        }
+
+        bounds.objects.assign(objects->data(), objects->data() + count);
+        bounds.minX.resize(count);
+        bounds.minY.resize(count);
+        bounds.maxX.resize(count);
+        bounds.maxY.resize(count);
+
+        for (int i = 0; i < count; i++) {
+            auto obj = bounds.objects[i];
+
+            if (!hasStaticRect(obj)) {
+                constexpr float inf = std::numeric_limits<float>::infinity();
+                bounds.minX[i] = -inf;
+                bounds.minY[i] = -inf;
+                bounds.maxX[i] = inf;
+                bounds.maxY[i] = inf;
+                continue;
+            }
+
+            // the rect rotates around the object's position, which is not always its center,
+            // so the circle reaches the farthest corner of the rect
+            auto rect = obj->getObjectRect();
+            auto pos = obj->getPosition();
+            float dx = std::max(std::abs(rect.getMinX() - pos.x), std::abs(rect.getMaxX() - pos.x));
+            float dy = std::max(std::abs(rect.getMinY() - pos.y), std::abs(rect.getMaxY() - pos.y));
+            float radius = std::sqrt(dx * dx + dy * dy);
+            float cx = pos.x;
+            float cy = pos.y;
+
+            bounds.minX[i] = cx - radius;
+            bounds.minY[i] = cy - radius;
+            bounds.maxX[i] = cx + radius;
+            bounds.maxY[i] = cy + radius;
+        }
+
+        return bounds;
+    }
+
+#ifdef BLAZE_DEBUG
+    // Skipped objects must not touch the player, otherwise the margin is too small or a static object changed its rect after all.
+    void verifySkippedObjects(PlayerObject* player, const SectionBounds& bounds, float qMinX, float qMaxX, float qMinY, float qMaxY) {
+        auto rect = player->getObjectRect();
+
+        for (size_t i = 0; i < bounds.objects.size(); i++) {
+            if (bounds.maxX[i] >= qMinX && bounds.minX[i] <= qMaxX && bounds.maxY[i] >= qMinY && bounds.minY[i] <= qMaxY) continue;
+
+            auto obj = bounds.objects[i];
+            if (obj->getObjectRect().intersectsRect(rect)) {
+                log::warn("Collision broadphase skipped object {} (id {}) that touches the player", fmt::ptr(obj), obj->m_objectID);
+            }
+        }
+    }
+#endif
+};
+
+struct CollisionBroadphasePlayLayer : Modify<CollisionBroadphasePlayLayer, PlayLayer> {
+    $override
+    void onQuit() {
+        // objects can be allocated at the same addresses in the next level
+        s_sectionBounds.clear();
+        s_boundsLayer = nullptr;
+        PlayLayer::onQuit();
+    }
+};
+
+#ifdef BLAZE_DEBUG
+struct TriggerReplayPlayLayer : Modify<TriggerReplayPlayLayer, PlayLayer> {
+    $override
+    void resetLevel() {
+        s_replay.onAttempt();
+        PlayLayer::resetLevel();
+    }
+
+    $override
+    void onQuit() {
+        if (s_replay.state == TriggerReplay::State::Verifying) {
+            s_replay.report();
+        }
+
+        s_replay = {};
+        PlayLayer::onQuit();
+    }
+};
+#endif
+
+}
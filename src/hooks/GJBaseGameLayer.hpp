@@ -0,0 +1,8 @@
+#pragma once
+
+namespace blaze {
+#ifdef BLAZE_DEBUG
+    // Makes the next attempt of a level record vanilla trigger results, which all following attempts are checked against.
+    void armTriggerReplayCheck();
+#endif
+}
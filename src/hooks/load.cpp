@@ -24,6 +24,8 @@
 #include <manager.hpp>
 #include <ccimageext.hpp>
 #include <settings.hpp>
+#include <prefetch.hpp>
+#include <profile.hpp>
 #include <tracing.hpp>
 #include <util/hash.hpp>
 #include <util/thread.hpp>
@@ -32,7 +34,12 @@
 #include "FMODAudioEngine.hpp"
 #include "CCTextureCache.hpp"
 #include "CCSpriteFrameCache.hpp"
+#include "load/bmfont.hpp"
+#include "load/framecache.hpp"
 #include "load/glfw.hpp"
+#include "load/lazy.hpp"
+#include "load/pbo.hpp"
+#include "load/plist.hpp"
 #include "load/spriteframes.hpp"
 
 
@@ -47,63 +54,108 @@ namespace {
 struct AsyncImageLoadRequest {
     const char* pngFile = nullptr;
     const char* plistFile = nullptr;
+    const char* fntFile = nullptr; // for fonts, `pngFile` is only known once this is parsed
     gd::string pathKey;
     blaze::OwnedMemoryChunk imageData{};
     Ref<CCImage> image = nullptr;
     Ref<CCTexture2D> texture = nullptr;
+    std::optional<blaze::PboUploader::Staging> staging;
 
     AsyncImageLoadRequest(const char* pngFile, const char* plistFile) : pngFile(pngFile), plistFile(plistFile) {}
     AsyncImageLoadRequest(const char* pngFile) : pngFile(pngFile), plistFile(nullptr) {}
 
+    static AsyncImageLoadRequest font(const char* fntFile) {
+        AsyncImageLoadRequest req{nullptr};
+        req.fntFile = fntFile;
+        return req;
+    }
+
     AsyncImageLoadRequest(const AsyncImageLoadRequest&) = delete;
     AsyncImageLoadRequest& operator=(const AsyncImageLoadRequest&) = delete;
 
     AsyncImageLoadRequest(AsyncImageLoadRequest&& other) {
         this->pngFile = other.pngFile;
         this->plistFile = other.plistFile;
+        this->fntFile = other.fntFile;
         this->pathKey = std::move(other.pathKey);
         this->imageData = std::move(other.imageData);
         this->image = std::move(other.image);
         this->texture = std::move(other.texture);
+        this->staging = std::exchange(other.staging, std::nullopt);
 
         other.pngFile = nullptr;
         other.plistFile = nullptr;
+        other.fntFile = nullptr;
+    }
+
+    ~AsyncImageLoadRequest() {
+        this->discardStaging();
     }
 
     AsyncImageLoadRequest& operator=(AsyncImageLoadRequest&& other) {
         if (this != &other) {
+            this->discardStaging();
+
             this->pngFile = other.pngFile;
             this->plistFile = other.plistFile;
+            this->fntFile = other.fntFile;
             this->pathKey = std::move(other.pathKey);
             this->imageData = std::move(other.imageData);
             this->image = std::move(other.image);
             this->texture = std::move(other.texture);
+            this->staging = std::exchange(other.staging, std::nullopt);
 
             other.pngFile = nullptr;
             other.plistFile = nullptr;
+            other.fntFile = nullptr;
         }
 
         return *this;
     }
 
+    // Gives the staging slot back if the image was never uploaded, for example when loading failed later on.
+    void discardStaging() {
+        if (staging) {
+            blaze::PboUploader::get().discard(*staging);
+            staging.reset();
+        }
+    }
+
+    const char* displayName() const {
+        return pngFile ? pngFile : (fntFile ? fntFile : "<null>");
+    }
+
     // Loads the encoded image data into memory. Does nothing if the image is already loaded.
     inline Result<> loadImage() {
         ZoneScoped;
-        blaze::ThreadSafeFileUtilsGuard _guard;
-
         if (imageData) return Ok();
 
+        if (!pngFile && fntFile) {
+            // parses the font and caches it, so creating the font configuration later on is cheap
+            auto font = blaze::loadFont(fntFile);
+            if (!font) {
+                return Err(fmt::format("Failed to load font file '{}'", fntFile));
+            }
+
+            // interned strings live forever, unlike the request
+            auto atlasName = blaze::fontAtlasName(*font, fntFile);
+            this->pngFile = blaze::internedString(blaze::internString(atlasName));
+        }
+
         this->pathKey = blaze::fullPathForFilename(pngFile, false);
         if (pathKey.empty()) {
             return Err(fmt::format("Failed to find path for image '{}'", pngFile));
         }
 
+        auto startTime = Instant::now();
         this->imageData = LoadManager::get().readFileToChunk(pathKey.c_str(), true);
 
         if (!imageData || imageData.size == 0) {
             return Err(fmt::format("Failed to open image file at '{}'", pathKey));
         }
 
+        blaze::LaunchProfile::get().record(pathKey.c_str(), blaze::LaunchProfile::Stage::Read, startTime.elapsed());
+
         return Ok();
     }
 
@@ -125,6 +177,9 @@ struct AsyncImageLoadRequest {
             return Err(fmt::format("Failed to load image: {}", ret.unwrapErr()));
         }
 
+        // if async uploads are enabled, move the pixels into a pixel buffer right away
+        this->staging = blaze::PboUploader::get().stage(this->image);
+
         return Ok();
     }
 
@@ -140,16 +195,37 @@ struct AsyncImageLoadRequest {
 
         if (!image) return Err("attempting to initialize a texture before initializing an image");
 
-        this->texture = new CCTexture2D();
-        this->texture->release(); // make refcount go to 1
+        auto startTime = Instant::now();
+        auto& uploader = blaze::PboUploader::get();
+        if (!staging) {
+            // image was decoded before GL was ready, or all slots were busy back then
+            this->staging = uploader.stage(image);
+        }
 
-        if (!texture->initWithImage(image)) {
-            this->image = nullptr;
-            this->texture = nullptr;
-            return Err("failed to initialize cctexture2d");;
+        if (staging) {
+            auto tex = uploader.upload(*staging);
+            this->staging.reset();
+
+            if (!tex) {
+                this->image = nullptr;
+                return Err("failed to upload texture from pixel buffer");
+            }
+
+            this->texture = tex;
+            this->texture->release(); // make refcount go to 1
+        } else {
+            this->texture = new CCTexture2D();
+            this->texture->release(); // make refcount go to 1
+
+            if (!texture->initWithImage(image)) {
+                this->image = nullptr;
+                this->texture = nullptr;
+                return Err("failed to initialize cctexture2d");;
+            }
         }
 
         blaze::BTextureCache::get().setTexture(pathKey, texture);
+        blaze::LaunchProfile::get().record(pathKey.c_str(), blaze::LaunchProfile::Stage::Upload, startTime.elapsed());
 
         return Ok();
     }
@@ -165,8 +241,6 @@ struct AsyncImageLoadRequest {
         BLAZE_ASSERT(texture != nullptr);
 
         ZoneScoped;
-        blaze::ThreadSafeFileUtilsGuard _guard;
-
         {
             ZoneScopedN("addSpriteFrames loading plist");
 
@@ -182,7 +256,7 @@ struct AsyncImageLoadRequest {
             std::unique_ptr<blaze::SpriteFrameData> spf;
             {
                 ZoneScopedN("addSpriteFrames parsing sprite frames");
-                auto res = blaze::parseSpriteFrames(dataptr.get(), size);
+                auto res = blaze::parseSpriteFramesCached(dataptr.get(), size);
 
                 if (res) {
                     spf = std::move(res).unwrap();
@@ -192,7 +266,7 @@ struct AsyncImageLoadRequest {
             }
 
             if (spf) {
-                ZoneScopedN("addSpriteFrames adding frames to cache")
+                ZoneScopedN("addSpriteFrames adding frames to cache");
 
                 // We don't do this check in release, but it's important that the texture file name parsed from the .plist
                 // is equal to the actual .png file that we loaded earlier.
@@ -216,9 +290,11 @@ struct AsyncImageLoadRequest {
                 }
 #endif
 
-                auto _lck = blaze::g_sfcacheMutex.lock();
+                // only the insertion needs the lock, the frames can be created in parallel with other sheets
+                auto batch = blaze::createSpriteFrames(*spf, texture);
 
-                blaze::addSpriteFrames(*spf, texture);
+                auto _lck = blaze::g_sfcacheMutex.lock();
+                blaze::insertSpriteFrames(std::move(batch));
             }
         }
     }
@@ -227,10 +303,18 @@ struct AsyncImageLoadRequest {
 
 #define MAKE_SHEET(name) textures.push_back(AsyncImageLoadRequest { name".png", name".plist" })
 #define MAKE_IMG(name) textures.push_back(AsyncImageLoadRequest { name".png" })
+#define MAKE_LAZY_SHEET(name) do { \
+        if (blaze::settings().lazySheets) blaze::LazySheets::get().registerSheet(name".png", name".plist"); \
+        else MAKE_SHEET(name); \
+    } while (0)
 #define MAKE_FONT(name) do { \
-        auto conf = FNTConfigLoadFile(name".fnt"); \
-        if (conf) textures.push_back(AsyncImageLoadRequest { conf->getAtlasName() }); \
-        else geode::log::warn("Failed to load font file: " name ".fnt"); \
+        if (blaze::settings().fastFonts) { \
+            textures.push_back(AsyncImageLoadRequest::font(name".fnt")); \
+        } else if (auto conf = FNTConfigLoadFile(name".fnt")) { \
+            textures.push_back(AsyncImageLoadRequest { conf->getAtlasName() }); \
+        } else { \
+            geode::log::warn("Failed to load font file: " name ".fnt"); \
+        } \
     } while (0)
 
 static std::vector<AsyncImageLoadRequest> getLoadingLayerResources() {
@@ -245,19 +329,24 @@ static std::vector<AsyncImageLoadRequest> getLoadingLayerResources() {
 
 static std::vector<AsyncImageLoadRequest> getGameResources() {
     std::vector<AsyncImageLoadRequest> textures;
+
+    if (blaze::settings().lazySheets) {
+        blaze::LazySheets::get().reset();
+    }
+
     MAKE_SHEET("GJ_GameSheet");
     MAKE_SHEET("GJ_GameSheet02");
     MAKE_SHEET("GJ_GameSheet03");
-    MAKE_SHEET("GJ_GameSheetEditor");
+    MAKE_LAZY_SHEET("GJ_GameSheetEditor");
     MAKE_SHEET("GJ_GameSheet04");
     MAKE_SHEET("GJ_GameSheetGlow");
 
     MAKE_SHEET("FireSheet_01");
-    MAKE_SHEET("GJ_ShopSheet");
+    MAKE_LAZY_SHEET("GJ_ShopSheet");
     MAKE_IMG("smallDot");
     MAKE_IMG("square02_001");
     MAKE_SHEET("GJ_ParticleSheet");
-    MAKE_SHEET("PixelSheet_01");
+    MAKE_LAZY_SHEET("PixelSheet_01");
 
     MAKE_SHEET("CCControlColourPickerSpriteSheet");
     MAKE_IMG("GJ_gradientBG");
@@ -342,6 +431,7 @@ static std::vector<AsyncImageLoadRequest> getGameResources() {
 #undef MAKE_SHEET
 #undef MAKE_IMG
 #undef MAKE_FONT
+#undef MAKE_LAZY_SHEET
 
 static Instant g_launchTime = Instant::now(); // right when the binary is loaded
 static Instant g_ccApplicationRunTime{};
@@ -380,14 +470,14 @@ static void asyncLoadLoadingLayerResources(std::vector<AsyncImageLoadRequest>&&
             if constexpr (!SkipLoadImage) {
                 res = item.loadImage();
                 if (!res) {
-                    log::warn("Error loading {}: {}", item.pngFile ? item.pngFile : "<null>", res.unwrapErr());
+                    log::warn("Error loading {}: {}", item.displayName(), res.unwrapErr());
                     return;
                 }
             }
 
             res = item.initImage();
             if (!res) {
-                log::warn("Error loading {}: {}", item.pngFile ? item.pngFile : "<null>", res.unwrapErr());
+                log::warn("Error loading {}: {}", item.displayName(), res.unwrapErr());
             } else {
                 g_preLoadStage.channel->push(std::move(item));
             }
@@ -412,14 +502,14 @@ static void asyncLoadGameResources(std::vector<AsyncImageLoadRequest>&& resource
             if constexpr (!SkipLoadImage) {
                 res = img.loadImage();
                 if (!res) {
-                    log::warn("Error loading {}: {}", img.pngFile, res.unwrapErr());
+                    log::warn("Error loading {}: {}", img.displayName(), res.unwrapErr());
                     return;
                 }
             }
 
             res = img.initImage();
             if (!res) {
-                log::warn("Error loading {}: {}", img.pngFile, res.unwrapErr());
+                log::warn("Error loading {}: {}", img.displayName(), res.unwrapErr());
             } else {
                 g_gameLoadStage.channel->push(&img);
             }
@@ -441,6 +531,8 @@ class $modify(MyLoadingLayer, LoadingLayer) {
     }
 
     bool init(bool fromReload) {
+        ZoneScopedN("LoadingLayer::init");
+
         m_fields->startedLoadingGame = Instant::now();
 
         BLAZE_TIMER_START("(LoadingLayer::init) Initial setup");
@@ -449,12 +541,17 @@ class $modify(MyLoadingLayer, LoadingLayer) {
 
         if (fromReload) {
             // Init threadpool
-            s_loadThreadPool.emplace(asp::ThreadPool{});
+            s_loadThreadPool.emplace(asp::ThreadPool{blaze::LaunchProfile::get().poolSize()});
+            blaze::setPlistParsePool(&*s_loadThreadPool);
         }
 
         this->m_fromRefresh = fromReload;
         CCDirector::get()->m_bDisplayStats = true;
 
+        if (blaze::settings().pboUpload && !blaze::settings().lowMemory) {
+            blaze::PboUploader::get().setup();
+        }
+
         if (fromReload) {
             // Load loadinglayer assets
             asyncLoadLoadingLayerResources(getLoadingLayerResources());
@@ -477,25 +574,29 @@ class $modify(MyLoadingLayer, LoadingLayer) {
 
         auto* sfcache = CCSpriteFrameCache::get();
 
-        while (true) {
-            if (g_preLoadStage.channel->empty()) {
-                if (!g_preLoadStage.thread->isStopped()) {
-                    std::this_thread::yield();
-                    continue;
-                } else if (g_preLoadStage.channel->empty()) {
-                    break;
+        {
+            ZoneScopedN("Wait for loading layer textures");
+
+            while (true) {
+                if (g_preLoadStage.channel->empty()) {
+                    if (!g_preLoadStage.thread->isStopped()) {
+                        std::this_thread::yield();
+                        continue;
+                    } else if (g_preLoadStage.channel->empty()) {
+                        break;
+                    }
                 }
-            }
 
-            auto iTask = g_preLoadStage.channel->popNow();
-            auto res = iTask.initTexture();
-            if (!res) {
-                log::warn("Failed to init texture for {}: {}", iTask.pngFile, res.unwrapErr());
-                continue;
-            }
+                auto iTask = g_preLoadStage.channel->popNow();
+                auto res = iTask.initTexture();
+                if (!res) {
+                    log::warn("Failed to init texture for {}: {}", iTask.pngFile, res.unwrapErr());
+                    continue;
+                }
 
-            if (iTask.plistFile) {
-                iTask.addSpriteFrames();
+                if (iTask.plistFile) {
+                    iTask.addSpriteFrames();
+                }
             }
         }
 
@@ -540,6 +641,12 @@ class $modify(MyLoadingLayer, LoadingLayer) {
             ObjectToolbox::sharedState();
         });
 
+        if (blaze::settings().lazySheets) {
+            s_loadThreadPool->pushTask([] {
+                blaze::LazySheets::get().indexFrames();
+            });
+        }
+
         BLAZE_TIMER_STEP("ObjectManager::setup");
 
         ObjectManager::instance()->setup();
@@ -573,42 +680,60 @@ class $modify(MyLoadingLayer, LoadingLayer) {
 
         BLAZE_TIMER_STEP("Main thread tasks");
 
-        while (true) {
-            if (g_gameLoadStage.channel->empty()) {
-                if (s_loadThreadPool->isDoingWork()) {
-                    std::this_thread::yield();
-                    continue;
-                } else if (g_gameLoadStage.channel->empty()) {
-                    break;
+        {
+            ZoneScopedN("Wait for game textures");
+
+            while (true) {
+                if (g_gameLoadStage.channel->empty()) {
+                    if (s_loadThreadPool->isDoingWork()) {
+                        std::this_thread::yield();
+                        continue;
+                    } else if (g_gameLoadStage.channel->empty()) {
+                        break;
+                    }
                 }
-            }
 
-            auto iTask = g_gameLoadStage.channel->popNow();
-            auto res = iTask->initTexture();
-            if (!res) {
-                log::warn("Failed to init texture for {}: {}", iTask->pngFile, res.unwrapErr());
-                continue;
-            }
+                auto iTask = g_gameLoadStage.channel->popNow();
+                auto res = iTask->initTexture();
+                if (!res) {
+                    log::warn("Failed to init texture for {}: {}", iTask->pngFile, res.unwrapErr());
+                    continue;
+                }
 
-            if (iTask->plistFile) {
-                s_loadThreadPool->pushTask([iTask] {
-                    iTask->addSpriteFrames();
-                });
+                if (iTask->plistFile) {
+                    s_loadThreadPool->pushTask([iTask] {
+                        iTask->addSpriteFrames();
+                    });
+                }
             }
         }
 
         BLAZE_TIMER_STEP("Wait for sprite frames");
 
-        // also ensure fmod is initialized
-        auto fae = HookedFMODAudioEngine::get();
         {
-            std::lock_guard lock(fae->m_fields->initMutex);
+            ZoneScopedN("Wait for sprite frames and FMOD");
+
+            // also ensure fmod is initialized
+            auto fae = HookedFMODAudioEngine::get();
+            {
+                std::lock_guard lock(fae->m_fields->initMutex);
+            }
+
+            s_loadThreadPool->join();
         }
 
-        s_loadThreadPool->join();
+        // sheets loaded lazily after this point are parsed on a single thread
+        blaze::setPlistParsePool(nullptr);
+
+        BLAZE_TIMER_STEP("Build sprite frame table");
+
+        blaze::buildSpriteFrameTable();
 
         BLAZE_TIMER_STEP("Final cleanup");
 
+        // waits for the last uploads to finish, must be done on the main thread
+        blaze::PboUploader::get().shutdown();
+
         CCTextInputNode::create(200.f, 50.f, "Temp", "Thonburi", 0x18, "bigFont.fnt");
 
         // cleanup in another thread because it can block for a few ms
@@ -616,6 +741,8 @@ class $modify(MyLoadingLayer, LoadingLayer) {
             g_preLoadStage.cleanup();
             g_gameLoadStage.cleanup();
             s_loadThreadPool.reset();
+
+            blaze::pruneSpriteFrameCache();
         }).detach();
 
         BLAZE_TIMER_END();
@@ -645,6 +772,11 @@ class $modify(MyLoadingLayer, LoadingLayer) {
 
         log::info("{} took {}, handing off..", m_fromRefresh ? "Reloading" : "Loading", tookTimeFull.toString());
 
+        if (!m_fromRefresh) {
+            blaze::LaunchProfile::get().save(tookTimeFull);
+            blaze::Prefetcher::get().finish();
+        }
+
 #ifdef BLAZE_DEBUG
         if (!m_fromRefresh) {
             log::debug("- Geode entry remainder: {}", g_ccApplicationRunTime.durationSince(g_launchTime).toString());
@@ -656,6 +788,9 @@ class $modify(MyLoadingLayer, LoadingLayer) {
         log::debug("- Asset loading: {}", finishTime.durationSince(m_fields->startedLoadingAssets).toString());
 #endif
 
+        // no-op unless this is the first load and the startup trace is enabled
+        blaze::trace::finish();
+
         m_fields->finishedLoading = true;
         m_loadStep = 14;
         LoadingLayer::loadAssets();
@@ -747,6 +882,15 @@ void blaze::startPreInit() {
 
     blaze::setMainThreadId();
 
+    if (blaze::settings().startupTrace) {
+        blaze::trace::start();
+    }
+
+    ZoneScoped;
+
+    // get the disk busy as early as possible, reading the files happens much later
+    blaze::Prefetcher::get().start();
+
     // Check if our compile-time crc32 algorithm works correctly (should never fail, but we'll keep as a sanity check)
     if (blaze::hashStringRuntime("hai uwu") != BLAZE_STRING_HASH("hai uwu")) {
         log::error("ERROR: blaze detected abnormality in the hashing algorithm.");
@@ -811,8 +955,10 @@ void blaze::startPreInit() {
     CCDirector::get()->updateContentScale((::TextureQuality)tq);
     CCTexture2D::setDefaultAlphaPixelFormat(cocos2d::kCCTexture2DPixelFormat_Default);
 
-    // Init threadpool
-    s_loadThreadPool.emplace(asp::ThreadPool{});
+    // Init threadpool, with the size that worked best on previous launches
+    blaze::LaunchProfile::get().load();
+    s_loadThreadPool.emplace(asp::ThreadPool{blaze::LaunchProfile::get().poolSize()});
+    blaze::setPlistParsePool(&*s_loadThreadPool);
 
     auto resources1 = getLoadingLayerResources();
     auto resources2 = getGameResources();
@@ -838,7 +984,17 @@ void blaze::startPreInit() {
     }
 
     // wait for all images to be preloaded (should be pretty quick, they are not decoded yet)
-    s_loadThreadPool->join();
+    {
+        ZoneScopedN("Wait for image preloading");
+        s_loadThreadPool->join();
+    }
+
+    // decode the most expensive images first, so that the pool doesn't end up waiting for one huge sheet at the very end
+    if (auto& profile = blaze::LaunchProfile::get(); profile.isEnabled()) {
+        std::stable_sort(resources2.begin(), resources2.end(), [&](const auto& a, const auto& b) {
+            return profile.estimatedCost(a.pathKey.c_str()) > profile.estimatedCost(b.pathKey.c_str());
+        });
+    }
 
     // start decoding the images in background
     asyncLoadLoadingLayerResources<true>(std::move(resources1));
@@ -850,11 +1006,15 @@ void blaze::startPreInit() {
 
     // wait until llm finishes initialization
     BLAZE_TIMER_STEP("Wait for LLM init job to finish");
-    llmLoadThread.join();
+    {
+        ZoneScopedN("Wait for LLM init job");
+        llmLoadThread.join();
+    }
 
 #ifdef GEODE_IS_WINDOWS
     if (glfwInitThread) {
         BLAZE_TIMER_STEP("Wait for async GLFW job to finish");
+        ZoneScopedN("Wait for async GLFW job");
         glfwInitThread->join();
     }
 #endif
@@ -0,0 +1,212 @@
+#include "bmfont.hpp"
+
+#include <util/concurrent_index.hpp>
+#include <util/hash.hpp>
+#include <util/string.hpp>
+#include <manager.hpp>
+#include <tracing.hpp>
+#include <fpff.hpp>
+
+#include <Geode/loader/Log.hpp>
+#include <fmt/core.h>
+
+#include <cstring>
+
+using namespace geode::prelude;
+
+namespace blaze {
+
+static ConcurrentIndex<std::shared_ptr<const FontData>> g_fontCache;
+
+namespace {
+    // Reads the `key=value` pairs of a single line. The first word of the line comes out as a key without a value.
+    struct LineReader {
+        const char* p;
+        const char* end;
+
+        static bool isSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        bool next(std::string_view& key, std::string_view& value) {
+            while (p < end && isSpace(*p)) p++;
+            if (p == end) return false;
+
+            const char* keyStart = p;
+            while (p < end && *p != '=' && !isSpace(*p)) p++;
+            key = std::string_view(keyStart, p - keyStart);
+
+            if (p == end || *p != '=') {
+                value = {};
+                return true;
+            }
+
+            p++;
+
+            if (p < end && *p == '"') {
+                const char* valueStart = ++p;
+                while (p < end && *p != '"') p++;
+                value = std::string_view(valueStart, p - valueStart);
+
+                if (p < end) p++;
+            } else {
+                const char* valueStart = p;
+                while (p < end && !isSpace(*p)) p++;
+                value = std::string_view(valueStart, p - valueStart);
+            }
+
+            return true;
+        }
+    };
+}
+
+#define parse_or_bail(var, fn, key, value) \
+    if (auto _res = fn(value)) { \
+        var = static_cast<std::remove_reference_t<decltype(var)>>(*_res); \
+    } else { \
+        return Err(fmt::format("invalid value for '{}' on line {}: '{}'", key, lineNumber, value)); \
+    }
+
+Result<std::unique_ptr<FontData>> parseFont(std::string_view data) {
+    ZoneScoped;
+
+    auto font = std::make_unique<FontData>();
+    bool hasCommon = false, hasPage = false;
+
+    // every character line is roughly 100 bytes, avoids a few reallocations
+    font->chars.reserve(data.size() / 100);
+
+    const char* p = data.data();
+    const char* end = data.data() + data.size();
+    size_t lineNumber = 0;
+
+    while (p < end) {
+        auto lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+
+        LineReader reader{p, lineEnd};
+        p = lineEnd + 1;
+        lineNumber++;
+
+        std::string_view keyword, key, value;
+        if (!reader.next(keyword, value)) continue;
+
+        if (keyword == "char") {
+            FontChar ch{};
+            int seen = 0;
+
+            while (reader.next(key, value)) {
+                if (key == "id") { parse_or_bail(ch.id, parseInt, key, value); seen |= 1; }
+                else if (key == "x") { parse_or_bail(ch.x, parseFloat, key, value); seen |= 2; }
+                else if (key == "y") { parse_or_bail(ch.y, parseFloat, key, value); seen |= 4; }
+                else if (key == "width") { parse_or_bail(ch.width, parseFloat, key, value); seen |= 8; }
+                else if (key == "height") { parse_or_bail(ch.height, parseFloat, key, value); seen |= 16; }
+                else if (key == "xoffset") { parse_or_bail(ch.xOffset, parseInt, key, value); seen |= 32; }
+                else if (key == "yoffset") { parse_or_bail(ch.yOffset, parseInt, key, value); seen |= 64; }
+                else if (key == "xadvance") { parse_or_bail(ch.xAdvance, parseInt, key, value); seen |= 128; }
+            }
+
+            if (seen != 255) {
+                return Err(fmt::format("incomplete character definition on line {}", lineNumber));
+            }
+
+            font->chars.push_back(ch);
+        } else if (keyword == "kerning") {
+            int first = 0, second = 0, amount = 0;
+            int seen = 0;
+
+            while (reader.next(key, value)) {
+                if (key == "first") { parse_or_bail(first, parseInt, key, value); seen |= 1; }
+                else if (key == "second") { parse_or_bail(second, parseInt, key, value); seen |= 2; }
+                else if (key == "amount") { parse_or_bail(amount, parseInt, key, value); seen |= 4; }
+            }
+
+            if (seen != 7) {
+                return Err(fmt::format("incomplete kerning entry on line {}", lineNumber));
+            }
+
+            font->kernings.push_back(FontKerning { (first << 16) | (second & 0xffff), amount });
+        } else if (keyword == "info") {
+            while (reader.next(key, value)) {
+                if (key != "padding") continue;
+
+                // padding=top,right,bottom,left
+                int* fields[] = { &font->padding.top, &font->padding.right, &font->padding.bottom, &font->padding.left };
+
+                for (auto field : fields) {
+                    auto comma = value.find(',');
+                    parse_or_bail(*field, parseInt, key, value.substr(0, comma));
+                    value = comma == std::string_view::npos ? std::string_view{} : value.substr(comma + 1);
+                }
+            }
+        } else if (keyword == "common") {
+            while (reader.next(key, value)) {
+                if (key == "lineHeight") {
+                    parse_or_bail(font->commonHeight, parseInt, key, value);
+                    hasCommon = true;
+                } else if (key == "pages" && value != "1") {
+                    return Err("only fonts with one page are supported");
+                }
+            }
+        } else if (keyword == "page") {
+            while (reader.next(key, value)) {
+                if (key == "id" && value != "0") {
+                    return Err("only fonts with one page are supported");
+                } else if (key == "file") {
+                    font->atlasFile = value;
+                    hasPage = true;
+                }
+            }
+        }
+    }
+
+    if (!hasCommon || !hasPage) {
+        return Err("missing common or page definition");
+    }
+
+    return Ok(std::move(font));
+}
+
+#undef parse_or_bail
+
+std::shared_ptr<const FontData> loadFont(const char* fntFile) {
+    auto fullPath = blaze::fullPathForFilename(fntFile);
+    if (fullPath.empty()) {
+        return nullptr;
+    }
+
+    std::string_view key{fullPath.data(), fullPath.size()};
+    uint64_t hash = hashStringRuntime64(key);
+
+    if (auto cached = g_fontCache.find(key, hash)) {
+        return std::move(*cached);
+    }
+
+    size_t size = 0;
+    auto data = LoadManager::get().readFile(fullPath.c_str(), size, true);
+    if (!data || size == 0) {
+        return nullptr;
+    }
+
+    auto res = parseFont(std::string_view{reinterpret_cast<const char*>(data.get()), size});
+    if (!res) {
+        log::warn("Failed to parse font {}: {}", fntFile, res.unwrapErr());
+        return nullptr;
+    }
+
+    std::shared_ptr<const FontData> font = std::move(res).unwrap();
+    g_fontCache.insert(key, hash, font);
+
+    return font;
+}
+
+std::string fontAtlasName(const FontData& font, std::string_view fntFile) {
+    // same as CCFileUtils::fullPathFromRelativeFile, minus the filename lookup dictionary that nobody uses
+    auto slash = fntFile.rfind('/');
+    std::string out{slash == std::string_view::npos ? std::string_view{} : fntFile.substr(0, slash + 1)};
+    out += font.atlasFile;
+
+    return out;
+}
+
+}
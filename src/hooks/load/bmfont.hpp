@@ -0,0 +1,48 @@
+#pragma once
+
+// BMFont (.fnt) parser.
+//
+// Cocos reads these line by line, splitting every line into std::strings and running sscanf on each field.
+// We walk the buffer once, read the key=value pairs in place and store characters and kerning pairs in flat arrays.
+// Parsed fonts are cached by their full path, so the loading threads can parse them ahead of time
+// and `CCBMFontConfiguration` only has to copy the data over.
+
+#include <Geode/Result.hpp>
+#include <cocos2d.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace blaze {
+
+struct FontChar {
+    uint32_t id;
+    float x, y, width, height;
+    int16_t xOffset, yOffset, xAdvance;
+};
+
+struct FontKerning {
+    int key; // first character in the upper 16 bits, second one in the lower 16 bits
+    int amount;
+};
+
+struct FontData {
+    int commonHeight = 0;
+    cocos2d::ccBMFontPadding padding{};
+    std::string atlasFile; // as written in the file, relative to the .fnt file
+    std::vector<FontChar> chars;
+    std::vector<FontKerning> kernings;
+};
+
+geode::Result<std::unique_ptr<FontData>> parseFont(std::string_view data);
+
+// Reads and parses the font file, or returns the cached font if it was loaded before. Thread safe.
+// Returns nullptr if the file could not be read or parsed.
+std::shared_ptr<const FontData> loadFont(const char* fntFile);
+
+// Path of the font atlas the way cocos builds it, which is the atlas file name in the directory of `fntFile`.
+std::string fontAtlasName(const FontData& font, std::string_view fntFile);
+
+}
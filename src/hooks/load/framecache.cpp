@@ -0,0 +1,318 @@
+#include "framecache.hpp"
+
+#include <algo/crc32.hpp>
+#include <util/mapped_file.hpp>
+#include <settings.hpp>
+#include <tracing.hpp>
+
+#include <Geode/loader/Log.hpp>
+#include <Geode/loader/Mod.hpp>
+#include <Geode/Prelude.hpp>
+#include <Geode/utils/file.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+using namespace geode::prelude;
+
+namespace blaze {
+
+namespace {
+    constexpr uint32_t CACHE_MAGIC = 0x43465342; // "BSFC"
+    constexpr uint32_t CACHE_VERSION = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t checksum;
+        uint32_t plistSize;
+        int32_t format;
+        uint32_t textureFileName; // offset into the string table
+        uint32_t frameCount;
+        uint32_t aliasCount;
+        uint32_t stringTableSize;
+    };
+
+    struct FrameRecord {
+        uint32_t name; // offset into the string table
+        float offsetX, offsetY;
+        float sourceWidth, sourceHeight;
+        float rectX, rectY, rectWidth, rectHeight;
+        uint32_t firstAlias;
+        uint16_t aliasCount;
+        uint16_t rotated;
+    };
+
+    // File layout: Header, FrameRecord[frameCount], uint32_t alias string offsets[aliasCount], string table
+    static_assert(sizeof(Header) == 36);
+    static_assert(sizeof(FrameRecord) == 44);
+
+    const std::filesystem::path& cacheDir() {
+        static std::filesystem::path dir = [] {
+            auto dir = Mod::get()->getSaveDir() / "cached-frames";
+            (void) file::createDirectoryAll(dir);
+            return dir;
+        }();
+
+        return dir;
+    }
+
+    std::filesystem::path cacheFile(uint32_t checksum, size_t plistSize) {
+        return cacheDir() / fmt::format("{:08x}-{}.bin", checksum, plistSize);
+    }
+
+    // Files that weren't loaded for this long are deleted, and the least recently used ones once the cache is bigger than this.
+    constexpr auto CACHE_MAX_AGE = std::chrono::days(30);
+    constexpr uintmax_t CACHE_MAX_SIZE = 64 * 1024 * 1024;
+    // a file's last use is only written down once per this long, so that loading doesn't write to every file on each launch
+    constexpr auto CACHE_TOUCH_INTERVAL = std::chrono::days(1);
+
+    // Marks the file as used by moving its modification time forward. Done before mapping it, as that can't be done on
+    // a file that is mapped on some platforms.
+    void touchCacheFile(const std::filesystem::path& path) {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return;
+
+        auto now = std::filesystem::file_time_type::clock::now();
+        if (now - time > CACHE_TOUCH_INTERVAL) {
+            std::filesystem::last_write_time(path, now, ec);
+        }
+    }
+}
+
+std::unique_ptr<SpriteFrameData> loadCachedSpriteFrames(uint32_t checksum, size_t plistSize) {
+    ZoneScoped;
+
+    auto path = cacheFile(checksum, plistSize);
+    touchCacheFile(path);
+
+    auto mapped = MappedFile::open(path);
+    if (!mapped) return nullptr;
+
+    const uint8_t* base = mapped->data();
+    size_t size = mapped->size();
+
+    if (size < sizeof(Header)) return nullptr;
+
+    Header header;
+    std::memcpy(&header, base, sizeof(Header));
+
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION
+        || header.checksum != checksum || header.plistSize != plistSize
+        || header.format < 0 || header.format > 3
+    ) {
+        return nullptr;
+    }
+
+    size_t framesOffset = sizeof(Header);
+    size_t aliasesOffset = framesOffset + (size_t) header.frameCount * sizeof(FrameRecord);
+    size_t stringsOffset = aliasesOffset + (size_t) header.aliasCount * sizeof(uint32_t);
+
+    if (stringsOffset + header.stringTableSize != size || header.stringTableSize == 0) {
+        log::warn("Sprite frame cache file for {:08x} is corrupted, ignoring", checksum);
+        return nullptr;
+    }
+
+    auto strings = reinterpret_cast<const char*>(base + stringsOffset);
+    if (strings[header.stringTableSize - 1] != '\0' || header.textureFileName >= header.stringTableSize) {
+        log::warn("Sprite frame cache file for {:08x} is corrupted, ignoring", checksum);
+        return nullptr;
+    }
+
+    auto records = reinterpret_cast<const FrameRecord*>(base + framesOffset);
+    auto aliases = reinterpret_cast<const uint32_t*>(base + aliasesOffset);
+
+    auto sfdata = std::make_unique<SpriteFrameData>();
+    sfdata->metadata.format = header.format;
+    sfdata->metadata.textureFileName = strings + header.textureFileName;
+    sfdata->frames.resize(header.frameCount);
+
+    for (size_t i = 0; i < header.frameCount; i++) {
+        const auto& rec = records[i];
+        auto& frame = sfdata->frames[i];
+
+        if (rec.name >= header.stringTableSize || (size_t) rec.firstAlias + rec.aliasCount > header.aliasCount) {
+            log::warn("Sprite frame cache file for {:08x} is corrupted, ignoring", checksum);
+            return nullptr;
+        }
+
+        frame.name = strings + rec.name;
+        frame.offset = CCPoint{rec.offsetX, rec.offsetY};
+        frame.sourceSize = CCSize{rec.sourceWidth, rec.sourceHeight};
+        frame.textureRect = CCRect{rec.rectX, rec.rectY, rec.rectWidth, rec.rectHeight};
+        frame.textureRotated = rec.rotated != 0;
+
+        for (size_t j = 0; j < rec.aliasCount; j++) {
+            uint32_t alias = aliases[rec.firstAlias + j];
+            if (alias >= header.stringTableSize) {
+                log::warn("Sprite frame cache file for {:08x} is corrupted, ignoring", checksum);
+                return nullptr;
+            }
+
+            frame.aliases.push_back(strings + alias);
+        }
+    }
+
+    sfdata->storage = std::make_shared<MappedFile>(std::move(*mapped));
+
+    return sfdata;
+}
+
+void cacheSpriteFrames(const SpriteFrameData& frames, uint32_t checksum, size_t plistSize) {
+    ZoneScoped;
+
+    std::vector<FrameRecord> records;
+    std::vector<uint32_t> aliases;
+    std::string strings;
+
+    records.reserve(frames.frames.size());
+
+    auto addString = [&](const char* str) -> uint32_t {
+        uint32_t offset = strings.size();
+        strings.append(str ? str : "");
+        strings.push_back('\0');
+        return offset;
+    };
+
+    uint32_t textureFileName = addString(frames.metadata.textureFileName);
+
+    for (const auto& frame : frames.frames) {
+        FrameRecord rec {
+            .name = addString(frame.name),
+            .offsetX = frame.offset.x,
+            .offsetY = frame.offset.y,
+            .sourceWidth = frame.sourceSize.width,
+            .sourceHeight = frame.sourceSize.height,
+            .rectX = frame.textureRect.origin.x,
+            .rectY = frame.textureRect.origin.y,
+            .rectWidth = frame.textureRect.size.width,
+            .rectHeight = frame.textureRect.size.height,
+            .firstAlias = (uint32_t) aliases.size(),
+            .aliasCount = (uint16_t) frame.aliases.size(),
+            .rotated = (uint16_t) frame.textureRotated,
+        };
+
+        for (auto alias : frame.aliases) {
+            aliases.push_back(addString(alias));
+        }
+
+        records.push_back(rec);
+    }
+
+    Header header {
+        .magic = CACHE_MAGIC,
+        .version = CACHE_VERSION,
+        .checksum = checksum,
+        .plistSize = (uint32_t) plistSize,
+        .format = frames.metadata.format,
+        .textureFileName = textureFileName,
+        .frameCount = (uint32_t) records.size(),
+        .aliasCount = (uint32_t) aliases.size(),
+        .stringTableSize = (uint32_t) strings.size(),
+    };
+
+    // write into a temporary file first, so that a crash midway can't leave a broken cache file behind
+    auto path = cacheFile(checksum, plistSize);
+    auto tmpPath = path;
+    tmpPath += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream file(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            log::warn("Failed to write sprite frame cache file {}", path);
+            return;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(FrameRecord));
+        file.write(reinterpret_cast<const char*>(aliases.data()), aliases.size() * sizeof(uint32_t));
+        file.write(strings.data(), strings.size());
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
+
+void pruneSpriteFrameCache() {
+    ZoneScoped;
+
+    struct CacheFile {
+        std::filesystem::path path;
+        std::filesystem::file_time_type time;
+        uintmax_t size;
+    };
+
+    std::vector<CacheFile> files;
+    uintmax_t totalSize = 0;
+    size_t removed = 0;
+    auto now = std::filesystem::file_time_type::clock::now();
+
+    std::error_code ec;
+    auto it = std::filesystem::directory_iterator(cacheDir(), ec);
+
+    for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        std::error_code fec;
+        auto time = it->last_write_time(fec);
+        auto size = fec ? 0 : it->file_size(fec);
+        if (fec) continue;
+
+        // temporary files are leftovers of writes that never finished
+        bool temporary = it->path().extension() == ".tmp";
+
+        if (now - time > (temporary ? CACHE_TOUCH_INTERVAL : CACHE_MAX_AGE)) {
+            if (std::filesystem::remove(it->path(), fec)) removed++;
+        } else if (!temporary) {
+            files.push_back({it->path(), time, size});
+            totalSize += size;
+        }
+    }
+
+    if (totalSize > CACHE_MAX_SIZE) {
+        std::sort(files.begin(), files.end(), [](auto& a, auto& b) { return a.time < b.time; });
+
+        for (auto& file : files) {
+            if (totalSize <= CACHE_MAX_SIZE) break;
+
+            std::error_code fec;
+            if (std::filesystem::remove(file.path, fec)) {
+                totalSize -= file.size;
+                removed++;
+            }
+        }
+    }
+
+    if (removed) {
+        log::debug("Removed {} unused sprite frame cache files", removed);
+    }
+}
+
+Result<std::unique_ptr<SpriteFrameData>> parseSpriteFramesCached(void* data, size_t size, bool ownBuffer) {
+    if (!blaze::settings().spriteFrameCache) {
+        return parseSpriteFrames(data, size, ownBuffer);
+    }
+
+    // has to be computed before parsing, pugixml modifies the buffer in place
+    uint32_t checksum = blaze::crc32(static_cast<const uint8_t*>(data), size);
+
+    if (auto cached = loadCachedSpriteFrames(checksum, size)) {
+        if (ownBuffer) {
+            pugi::get_memory_deallocation_function()(data);
+        }
+
+        return Ok(std::move(cached));
+    }
+
+    GEODE_UNWRAP_INTO(auto sfdata, parseSpriteFrames(data, size, ownBuffer));
+    cacheSpriteFrames(*sfdata, checksum, size);
+
+    return Ok(std::move(sfdata));
+}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// Binary sprite frame cache.
+//
+// The first time a plist is parsed, its frames are written into a compact binary file (fixed-size frame records followed
+// by a string table), named after the crc32 and size of the plist contents. On later launches that file is mapped
+// into memory and turned into `SpriteFrameData` directly, skipping XML and float parsing entirely.
+
+#include "spriteframes.hpp"
+
+namespace blaze {
+
+// Like `parseSpriteFrames`, but goes through the binary cache if it's enabled.
+// If `ownBuffer` is true, the buffer is freed in both cases, otherwise it may be referenced by the returned data.
+geode::Result<std::unique_ptr<SpriteFrameData>> parseSpriteFramesCached(void* data, size_t size, bool ownBuffer = false);
+
+// Loads sprite frames from the binary cache. Returns nullptr if the plist is not cached, or if the cache file is invalid.
+std::unique_ptr<SpriteFrameData> loadCachedSpriteFrames(uint32_t checksum, size_t plistSize);
+
+// Writes sprite frames into the binary cache.
+void cacheSpriteFrames(const SpriteFrameData& frames, uint32_t checksum, size_t plistSize);
+
+// Deletes cache files that weren't loaded for a while (like ones for plists that changed since), and the least recently used
+// ones while the cache is too big. Goes through the whole cache directory, so it should not run on the main thread.
+void pruneSpriteFrameCache();
+
+}
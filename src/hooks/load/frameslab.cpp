@@ -0,0 +1,122 @@
+#include "frameslab.hpp"
+
+#include <util/assert.hpp>
+#include <tracing.hpp>
+
+#include <asp/sync/Mutex.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace blaze {
+
+// sorted by address, so that `isSpriteFrameUnused` can find the slab of a frame
+static asp::Mutex<std::vector<std::unique_ptr<SpriteFrameSlab>>> g_slabs;
+
+static bool slabBefore(const std::unique_ptr<SpriteFrameSlab>& a, const std::unique_ptr<SpriteFrameSlab>& b) {
+    return std::less<>{}(a->at(0), b->at(0));
+}
+
+SpriteFrameSlab::SpriteFrameSlab(size_t capacity) : m_capacity(capacity), m_destroyed(capacity, false) {
+    m_frames = static_cast<CCSpriteFrame*>(
+        ::operator new(sizeof(CCSpriteFrame) * std::max<size_t>(capacity, 1), std::align_val_t{alignof(CCSpriteFrame)})
+    );
+}
+
+SpriteFrameSlab::~SpriteFrameSlab() {
+    for (size_t i = 0; i < m_size; i++) {
+        if (!m_destroyed[i]) {
+            m_frames[i].~CCSpriteFrame();
+        }
+    }
+
+    ::operator delete(m_frames, std::align_val_t{alignof(CCSpriteFrame)});
+}
+
+CCSpriteFrame* SpriteFrameSlab::emplace(
+    CCTexture2D* texture,
+    const CCRect& rect,
+    bool rotated,
+    const CCPoint& offset,
+    const CCSize& originalSize
+) {
+    BLAZE_ASSERT(m_size < m_capacity);
+
+    // the frame starts with a refcount of 1, which is the reference owned by the slab
+    auto frame = new (m_frames + m_size) CCSpriteFrame();
+
+    if (!frame->initWithTexture(texture, rect, rotated, offset, originalSize)) {
+        frame->~CCSpriteFrame();
+        return nullptr;
+    }
+
+    m_size++;
+    m_live++;
+    return frame;
+}
+
+CCSpriteFrame* SpriteFrameSlab::at(size_t i) const {
+    BLAZE_ASSERT(i < m_size);
+    return m_frames + i;
+}
+
+size_t SpriteFrameSlab::size() const {
+    return m_size;
+}
+
+bool SpriteFrameSlab::owns(const CCSpriteFrame* frame) const {
+    return std::less_equal<>{}(m_frames, frame) && std::less<>{}(frame, m_frames + m_size);
+}
+
+bool SpriteFrameSlab::destroyUnused() {
+    for (size_t i = 0; i < m_size; i++) {
+        if (!m_destroyed[i] && m_frames[i].retainCount() == 1) {
+            m_frames[i].~CCSpriteFrame();
+            m_destroyed[i] = true;
+            m_live--;
+        }
+    }
+
+    return m_live == 0;
+}
+
+void registerSpriteFrameSlab(std::unique_ptr<SpriteFrameSlab> slab) {
+    if (slab->size() == 0) return;
+
+    auto slabs = g_slabs.lock();
+    auto it = std::upper_bound(slabs->begin(), slabs->end(), slab, slabBefore);
+    slabs->insert(it, std::move(slab));
+}
+
+void sweepSpriteFrameSlabs() {
+    ZoneScoped;
+
+    // destroying frames releases their textures, don't do that while holding the lock
+    std::vector<std::unique_ptr<SpriteFrameSlab>> slabs = std::move(*g_slabs.lock());
+
+    std::erase_if(slabs, [](auto& slab) { return slab->destroyUnused(); });
+
+    // slabs registered in the meantime have to be kept as well
+    auto current = g_slabs.lock();
+    std::move(current->begin(), current->end(), std::back_inserter(slabs));
+    std::sort(slabs.begin(), slabs.end(), slabBefore);
+    *current = std::move(slabs);
+}
+
+bool isSpriteFrameUnused(const CCSpriteFrame* frame) {
+    auto slabs = g_slabs.lock();
+
+    auto it = std::upper_bound(slabs->begin(), slabs->end(), frame, [](const CCSpriteFrame* frame, auto& slab) {
+        return std::less<>{}(frame, slab->at(0));
+    });
+
+    bool inSlab = it != slabs->begin() && (*std::prev(it))->owns(frame);
+    return frame->retainCount() == (inSlab ? 2 : 1);
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// Pooled allocation of sprite frames.
+//
+// All frames of a sheet are constructed in one contiguous slab instead of with a `new` each.
+// They are refcounted as usual, but once the count hits zero cocos would `delete` the frame, which can't be done to memory
+// in the middle of a slab. So the slab keeps one reference to each of its frames for itself, and is swept whenever
+// the sprite frame cache drops frames: frames that nothing but the slab references are destroyed in place (releasing
+// their texture), and the slab's memory is freed once all of its frames are gone.
+//
+// Because of that extra reference, an unused slab frame has a refcount of 2 while in the sprite frame cache, which
+// vanilla `removeUnusedSpriteFrames` doesn't know about. See `isSpriteFrameUnused`.
+
+#include <cocos2d.h>
+
+#include <memory>
+#include <vector>
+
+namespace blaze {
+
+class SpriteFrameSlab {
+public:
+    explicit SpriteFrameSlab(size_t capacity);
+    ~SpriteFrameSlab();
+
+    SpriteFrameSlab(const SpriteFrameSlab&) = delete;
+    SpriteFrameSlab& operator=(const SpriteFrameSlab&) = delete;
+
+    // Constructs and initializes the next frame. Returns nullptr if `initWithTexture` fails, the slot is reused then.
+    cocos2d::CCSpriteFrame* emplace(
+        cocos2d::CCTexture2D* texture,
+        const cocos2d::CCRect& rect,
+        bool rotated,
+        const cocos2d::CCPoint& offset,
+        const cocos2d::CCSize& originalSize
+    );
+
+    cocos2d::CCSpriteFrame* at(size_t i) const;
+    size_t size() const;
+
+    bool owns(const cocos2d::CCSpriteFrame* frame) const;
+
+    // Destroys the frames that nothing but the slab references anymore. Returns true once no frames are left.
+    bool destroyUnused();
+
+private:
+    cocos2d::CCSpriteFrame* m_frames;
+    size_t m_capacity;
+    size_t m_size = 0;
+    size_t m_live = 0;
+    std::vector<bool> m_destroyed;
+};
+
+// Hands the slab over to the global list, so that it gets freed once its frames are no longer used. Thread safe.
+void registerSpriteFrameSlab(std::unique_ptr<SpriteFrameSlab> slab);
+
+// Destroys the frames of registered slabs that are no longer used, and frees the slabs that have none left.
+// Should be called on the main thread after frames are removed from the cache.
+void sweepSpriteFrameSlabs();
+
+// Whether the sprite frame is only referenced by the sprite frame cache (and its slab, if it's in one). Main thread only.
+bool isSpriteFrameUnused(const cocos2d::CCSpriteFrame* frame);
+
+}
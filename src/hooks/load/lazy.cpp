@@ -0,0 +1,296 @@
+#include "lazy.hpp"
+
+#include <Geode/Geode.hpp>
+#include <Geode/modify/EditLevelLayer.hpp>
+#include <Geode/modify/LevelInfoLayer.hpp>
+#include <Geode/modify/GJGarageLayer.hpp>
+
+#include <ccimageext.hpp>
+#include <manager.hpp>
+#include <tracing.hpp>
+#include <fpff.hpp>
+#include <util/thread.hpp>
+
+#include "../CCSpriteFrameCache.hpp"
+#include "../CCTextureCache.hpp"
+
+using namespace geode::prelude;
+
+namespace blaze {
+
+void LazySheets::registerSheet(const char* pngFile, const char* plistFile) {
+    auto storage = m_storage.lock();
+    storage->sheets.push_back(Sheet {
+        .pngFile = pngFile,
+        .plistFile = plistFile,
+    });
+
+    m_pending.fetch_add(1, std::memory_order::relaxed);
+}
+
+void LazySheets::indexFrames() {
+    ZoneScoped;
+
+    size_t count = m_storage.lock()->sheets.size();
+
+    for (size_t i = 0; i < count; i++) {
+        const char* plistFile = m_storage.lock()->sheets[i].plistFile;
+
+        // this also caches the parsed data, so the plist won't be parsed again once the sheet is loaded
+        auto frames = blaze::loadSpriteFrames(plistFile);
+        if (!frames) {
+            log::warn("Failed to index frames of {}, it will only be loaded when requested explicitly", plistFile);
+            continue;
+        }
+
+        auto storage = m_storage.lock();
+        storage->sheets[i].frames = frames;
+
+        for (const auto& frame : frames->frames) {
+            storage->frameIndex.emplace(frame.name, i);
+        }
+    }
+}
+
+void LazySheets::reset() {
+    while (true) {
+        {
+            auto storage = m_storage.lock();
+
+            bool decoding = std::any_of(storage->sheets.begin(), storage->sheets.end(), [](const Sheet& sheet) {
+                return sheet.state == State::Decoding;
+            });
+
+            if (!decoding) {
+                for (auto& sheet : storage->sheets) {
+                    if (sheet.image) sheet.image->release();
+                }
+
+                storage->sheets.clear();
+                storage->frameIndex.clear();
+                m_pending.store(0, std::memory_order::relaxed);
+                return;
+            }
+        }
+
+        // wait for the prefetch thread to finish
+        std::this_thread::yield();
+    }
+}
+
+bool LazySheets::hasPending() const {
+    return m_pending.load(std::memory_order::relaxed) != 0;
+}
+
+void LazySheets::ensureLoadedForFrame(const char* frameName) {
+    // textures can only be created on the main thread
+    if (!frameName || !this->hasPending() || !blaze::isMainThread()) return;
+
+    size_t idx;
+
+    {
+        auto storage = m_storage.lock();
+        auto it = storage->frameIndex.find(frameName);
+        if (it == storage->frameIndex.end()) return;
+
+        idx = it->second;
+        if (storage->sheets[idx].state == State::Loaded) return;
+    }
+
+    this->loadNow(idx);
+}
+
+bool LazySheets::ensureLoadedForPlist(const char* plistFile) {
+    if (!plistFile || !this->hasPending() || !blaze::isMainThread()) return false;
+
+    std::optional<size_t> idx;
+
+    {
+        auto storage = m_storage.lock();
+        for (size_t i = 0; i < storage->sheets.size(); i++) {
+            if (std::strcmp(storage->sheets[i].plistFile, plistFile) == 0) {
+                idx = i;
+                break;
+            }
+        }
+    }
+
+    if (!idx) return false;
+
+    this->loadNow(*idx);
+    return true;
+}
+
+void LazySheets::prefetch(std::string_view sheetName) {
+    if (!this->hasPending()) return;
+
+    size_t idx;
+
+    {
+        auto storage = m_storage.lock();
+
+        auto it = std::find_if(storage->sheets.begin(), storage->sheets.end(), [&](const Sheet& sheet) {
+            std::string_view png = sheet.pngFile;
+            return png.size() == sheetName.size() + 4 && png.starts_with(sheetName) && png.ends_with(".png");
+        });
+
+        if (it == storage->sheets.end() || it->state != State::Registered) return;
+
+        it->state = State::Decoding;
+        idx = it - storage->sheets.begin();
+    }
+
+    std::thread([this, idx] {
+        utils::thread::setName("Blaze Prefetch");
+
+        this->decode(idx);
+
+        Loader::get()->queueInMainThread([this, idx] {
+            this->finish(idx);
+        });
+    }).detach();
+}
+
+void LazySheets::loadNow(size_t idx) {
+    ZoneScoped;
+
+    bool needsDecode = false;
+
+    while (true) {
+        {
+            auto storage = m_storage.lock();
+            auto& state = storage->sheets[idx].state;
+
+            if (state == State::Loaded) {
+                return;
+            } else if (state == State::Registered) {
+                state = State::Decoding;
+                needsDecode = true;
+                break;
+            } else if (state == State::Decoded) {
+                break;
+            }
+        }
+
+        // the sheet is being prefetched right now, wait for it
+        std::this_thread::yield();
+    }
+
+    if (needsDecode) {
+        this->decode(idx);
+    }
+
+    this->finish(idx);
+}
+
+void LazySheets::decode(size_t idx) {
+    ZoneScoped;
+
+    const char* pngFile = m_storage.lock()->sheets[idx].pngFile;
+
+    auto pathKey = blaze::fullPathForFilename(pngFile, false);
+    auto data = LoadManager::get().readFileToChunk(pathKey.c_str(), true);
+
+    CCImage* image = nullptr;
+
+    if (data && data.size != 0) {
+        image = new CCImage();
+
+        auto res = static_cast<CCImageExt*>(image)->initWithSPNGOrCache(data, pathKey.c_str());
+        if (!res) {
+            log::warn("Failed to decode {}: {}", pngFile, res.unwrapErr());
+            image->release();
+            image = nullptr;
+        }
+    } else {
+        log::warn("Failed to open image file at '{}'", pathKey);
+    }
+
+    auto storage = m_storage.lock();
+    auto& sheet = storage->sheets[idx];
+    sheet.image = image;
+    sheet.pathKey = std::move(pathKey);
+    sheet.state = State::Decoded;
+}
+
+void LazySheets::finish(size_t idx) {
+    ZoneScoped;
+    BLAZE_ASSERT_MAIN_THREAD;
+
+    CCImage* image;
+    gd::string pathKey;
+    std::shared_ptr<SpriteFrameData> frames;
+    const char* plistFile;
+
+    {
+        auto storage = m_storage.lock();
+
+        // can happen if resources were reloaded while prefetching
+        if (idx >= storage->sheets.size()) return;
+
+        auto& sheet = storage->sheets[idx];
+        if (sheet.state != State::Decoded) return;
+
+        sheet.state = State::Loaded;
+        image = std::exchange(sheet.image, nullptr);
+        pathKey = sheet.pathKey;
+        frames = sheet.frames;
+        plistFile = sheet.plistFile;
+    }
+
+    m_pending.fetch_sub(1, std::memory_order::relaxed);
+
+    if (!image) return;
+
+    auto texture = new CCTexture2D();
+    if (!texture->initWithImage(image)) {
+        log::warn("Failed to initialize texture for {}", pathKey);
+        texture->release();
+        image->release();
+        return;
+    }
+
+    blaze::BTextureCache::get().setTexture(pathKey, texture);
+
+    if (frames) {
+        auto batch = blaze::createSpriteFrames(*frames, texture);
+
+        auto _lck = blaze::g_sfcacheMutex.lock();
+        blaze::insertSpriteFrames(std::move(batch));
+    } else {
+        // indexing failed, let cocos deal with the plist
+        CCSpriteFrameCache::get()->addSpriteFramesWithFile(plistFile, texture);
+    }
+
+    texture->release();
+    image->release();
+}
+
+}
+
+// Scene transition hints, start loading sheets a bit before they are actually needed
+
+class $modify(EditLevelLayer) {
+    bool init(GJGameLevel* level) {
+        blaze::LazySheets::get().prefetch("GJ_GameSheetEditor");
+        blaze::LazySheets::get().prefetch("PixelSheet_01");
+
+        return EditLevelLayer::init(level);
+    }
+};
+
+class $modify(LevelInfoLayer) {
+    bool init(GJGameLevel* level, bool challenge) {
+        blaze::LazySheets::get().prefetch("PixelSheet_01");
+
+        return LevelInfoLayer::init(level, challenge);
+    }
+};
+
+class $modify(GJGarageLayer) {
+    bool init() {
+        blaze::LazySheets::get().prefetch("GJ_ShopSheet");
+
+        return GJGarageLayer::init();
+    }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+// Lazy loading of rarely used sprite sheets.
+//
+// Registered sheets are not decoded during launch, only their plists are parsed to know which frames they contain.
+// A sheet is loaded the first time one of its frames is requested from `CCSpriteFrameCache`, or earlier in the background
+// when a scene hints that it will be needed soon (e.g. opening a level page prefetches the editor sheet).
+
+#include <asp/sync/Mutex.hpp>
+#include <cocos2d.h>
+#include <util.hpp>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+#include "spriteframes.hpp"
+
+namespace blaze {
+
+class LazySheets : public SingletonBase<LazySheets> {
+    friend class SingletonBase;
+    LazySheets() = default;
+
+public:
+    // Registers a sheet to be loaded on demand. Both names must be string literals.
+    void registerSheet(const char* pngFile, const char* plistFile);
+
+    // Parses the plists of all registered sheets and builds the frame name index. Can be called on any thread.
+    void indexFrames();
+
+    // Forgets all registered sheets, called when the game reloads its resources.
+    void reset();
+
+    // Returns true if there are any registered sheets that have not been loaded yet.
+    bool hasPending() const;
+
+    // If the frame belongs to a sheet that has not been loaded yet, loads it. Must be called on the main thread.
+    void ensureLoadedForFrame(const char* frameName);
+
+    // If the plist belongs to a registered sheet, loads it and returns true. Must be called on the main thread.
+    bool ensureLoadedForPlist(const char* plistFile);
+
+    // Starts decoding the sheet in the background, the texture and frames are added on the main thread afterwards.
+    // `sheetName` is the name without extension, e.g. "GJ_GameSheetEditor".
+    void prefetch(std::string_view sheetName);
+
+private:
+    enum class State {
+        Registered, Decoding, Decoded, Loaded
+    };
+
+    struct Sheet {
+        const char* pngFile;
+        const char* plistFile;
+        std::shared_ptr<SpriteFrameData> frames;
+        State state = State::Registered;
+        cocos2d::CCImage* image = nullptr;
+        gd::string pathKey;
+    };
+
+    struct Storage {
+        // deque so that references stay valid when registering more sheets
+        std::deque<Sheet> sheets;
+        std::unordered_map<std::string_view, size_t> frameIndex;
+    };
+
+    asp::Mutex<Storage> m_storage;
+    std::atomic_size_t m_pending = 0;
+
+    void loadNow(size_t idx);
+    void decode(size_t idx);
+    void finish(size_t idx);
+};
+
+}
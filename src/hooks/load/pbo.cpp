@@ -0,0 +1,230 @@
+#include "pbo.hpp"
+
+#include <ccimageext.hpp>
+#include <tracing.hpp>
+#include <util/thread.hpp>
+
+#include <Geode/loader/Log.hpp>
+#include <Geode/Prelude.hpp>
+
+using namespace geode::prelude;
+
+namespace {
+    // Gives access to the protected premultiplied alpha flag, which `initWithImage` would normally set
+    struct CCTexture2DExt : public CCTexture2D {
+        void setPremultipliedAlpha(bool premultiplied) {
+            m_bHasPremultipliedAlpha = premultiplied;
+        }
+    };
+}
+
+namespace blaze {
+
+bool PboUploader::isActive() const {
+    return m_active.load(std::memory_order::acquire);
+}
+
+#ifdef BLAZE_PBO_UPLOAD_SUPPORTED
+
+constexpr GLbitfield MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+void PboUploader::setup() {
+    ZoneScoped;
+    BLAZE_ASSERT_MAIN_THREAD;
+
+    if (this->isActive()) return;
+
+    if (!GLEW_ARB_buffer_storage || !GLEW_ARB_sync || !GLEW_ARB_pixel_buffer_object) {
+        log::warn("Async texture uploads are unavailable, the required OpenGL extensions are not supported");
+        return;
+    }
+
+    for (auto& slot : m_slots) {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, SLOT_SIZE, nullptr, MAP_FLAGS);
+        slot.mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, SLOT_SIZE, MAP_FLAGS));
+
+        if (!slot.mapped) {
+            log::warn("Failed to map pixel buffer (GL error {}), async texture uploads are disabled", glGetError());
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            this->destroyBuffers();
+            return;
+        }
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    m_active.store(true, std::memory_order::release);
+}
+
+void PboUploader::shutdown() {
+    ZoneScoped;
+    BLAZE_ASSERT_MAIN_THREAD;
+
+    if (!this->isActive()) return;
+
+    m_active.store(false, std::memory_order::release);
+
+    this->retire(true);
+    this->destroyBuffers();
+}
+
+void PboUploader::destroyBuffers() {
+    for (auto& slot : m_slots) {
+        if (slot.mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        if (slot.fence) {
+            glDeleteSync(static_cast<GLsync>(slot.fence));
+        }
+
+        if (slot.buffer) {
+            glDeleteBuffers(1, &slot.buffer);
+        }
+
+        slot = Slot{};
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void PboUploader::retire(bool wait) {
+    auto _lck = m_mutex.lock();
+
+    for (auto& slot : m_slots) {
+        if (slot.state != SlotState::InFlight) continue;
+
+        auto res = glClientWaitSync(
+            static_cast<GLsync>(slot.fence),
+            wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+            wait ? 1'000'000'000 : 0
+        );
+
+        if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED || (wait && res == GL_WAIT_FAILED)) {
+            glDeleteSync(static_cast<GLsync>(slot.fence));
+            slot.fence = nullptr;
+            slot.state = SlotState::Free;
+        }
+    }
+}
+
+std::optional<size_t> PboUploader::acquireSlot() {
+    auto _lck = m_mutex.lock();
+
+    for (size_t i = 0; i < m_slots.size(); i++) {
+        if (m_slots[i].state == SlotState::Free) {
+            m_slots[i].state = SlotState::Writing;
+            return i;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<PboUploader::Staging> PboUploader::stage(CCImage* image) {
+    if (!this->isActive() || !image) return std::nullopt;
+
+    ZoneScoped;
+
+    auto ext = static_cast<CCImageExt*>(image);
+    uint32_t width = image->getWidth();
+    uint32_t height = image->getHeight();
+    size_t size = static_cast<size_t>(width) * height * 4;
+
+    // Only plain RGBA8 images are uploaded this way, anything else needs conversion that `initWithImage` does for us
+    if (!ext->getImageData()
+        || !image->hasAlpha()
+        || image->getBitsPerComponent() != 8
+        || size == 0 || size > SLOT_SIZE
+        || CCTexture2D::defaultAlphaPixelFormat() != kCCTexture2DPixelFormat_RGBA8888
+    ) {
+        return std::nullopt;
+    }
+
+    // only the main thread may touch fences
+    if (blaze::isMainThread()) {
+        this->retire(false);
+    }
+
+    auto slotIdx = this->acquireSlot();
+    if (!slotIdx) {
+        return std::nullopt;
+    }
+
+    auto& slot = m_slots[*slotIdx];
+    std::memcpy(slot.mapped, ext->getImageData(), size);
+
+    // the pixels live in the pixel buffer now, no need to keep them around until the texture is created
+    ext->setImageData(nullptr);
+
+    {
+        auto _lck = m_mutex.lock();
+        slot.state = SlotState::Ready;
+    }
+
+    return Staging {
+        .slot = *slotIdx,
+        .width = width,
+        .height = height,
+        .premultiplied = image->isPremultipliedAlpha(),
+    };
+}
+
+CCTexture2D* PboUploader::upload(const Staging& staging) {
+    ZoneScoped;
+    BLAZE_ASSERT_MAIN_THREAD;
+
+    auto& slot = m_slots[staging.slot];
+    BLAZE_ASSERT(slot.state == SlotState::Ready);
+
+    auto texture = new CCTexture2D();
+
+    // allocates storage without copying any data
+    if (!texture->initWithData(
+        nullptr,
+        kCCTexture2DPixelFormat_RGBA8888,
+        staging.width, staging.height,
+        CCSize(staging.width, staging.height)
+    )) {
+        texture->release();
+        this->discard(staging);
+        return nullptr;
+    }
+
+    ccGLBindTexture2D(texture->getName());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, staging.width, staging.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    static_cast<CCTexture2DExt*>(texture)->setPremultipliedAlpha(staging.premultiplied);
+
+    auto _lck = m_mutex.lock();
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.state = SlotState::InFlight;
+
+    return texture;
+}
+
+void PboUploader::discard(const Staging& staging) {
+    auto _lck = m_mutex.lock();
+    m_slots[staging.slot].state = SlotState::Free;
+}
+
+#else
+
+void PboUploader::setup() {}
+void PboUploader::shutdown() {}
+void PboUploader::retire(bool) {}
+void PboUploader::destroyBuffers() {}
+std::optional<size_t> PboUploader::acquireSlot() { return std::nullopt; }
+std::optional<PboUploader::Staging> PboUploader::stage(CCImage*) { return std::nullopt; }
+CCTexture2D* PboUploader::upload(const Staging&) { return nullptr; }
+void PboUploader::discard(const Staging&) {}
+
+#endif // BLAZE_PBO_UPLOAD_SUPPORTED
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+// Streaming texture uploads through persistently mapped pixel buffer objects.
+//
+// Decoded pixels are copied into a staging slot (this can happen on any thread), after which the main thread
+// issues a `glTexSubImage2D` sourcing from the PBO. The driver does not need to make its own copy of the client memory,
+// and the transfer to the GPU happens asynchronously while the CPU keeps loading other resources.
+
+#include <Geode/platform/cplatform.h>
+#include <asp/sync/Mutex.hpp>
+#include <cocos2d.h>
+#include <util.hpp>
+
+#include <array>
+#include <atomic>
+#include <optional>
+
+#ifdef GEODE_IS_WINDOWS
+# define BLAZE_PBO_UPLOAD_SUPPORTED 1
+#endif
+
+namespace blaze {
+
+class PboUploader : public SingletonBase<PboUploader> {
+    friend class SingletonBase;
+    PboUploader() = default;
+
+public:
+    struct Staging {
+        size_t slot;
+        uint32_t width;
+        uint32_t height;
+        bool premultiplied;
+    };
+
+    // Creates the buffer ring. Must be called on the main thread, after the GL context has been created.
+    // Does nothing if the required GL extensions are unavailable.
+    void setup();
+
+    // Waits for all in-flight uploads and destroys the buffer ring. Must be called on the main thread.
+    void shutdown();
+
+    bool isActive() const;
+
+    // Copies the pixels of the image into a free staging slot and frees the image's own pixel buffer. Can be called on any thread.
+    // Returns `std::nullopt` if the image is not eligible or no slot is free, in which case the image is left untouched.
+    std::optional<Staging> stage(cocos2d::CCImage* image);
+
+    // Creates a texture from a staged image. Must be called on the main thread.
+    // The returned texture is owned by the caller, nullptr is returned on failure.
+    cocos2d::CCTexture2D* upload(const Staging& staging);
+
+    // Releases a staged image without uploading it.
+    void discard(const Staging& staging);
+
+private:
+    enum class SlotState : uint8_t {
+        Free, Writing, Ready, InFlight
+    };
+
+    struct Slot {
+        unsigned int buffer = 0;
+        uint8_t* mapped = nullptr;
+        void* fence = nullptr;
+        SlotState state = SlotState::Free;
+    };
+
+    // Fits a 4096x4096 RGBA8 atlas, which is the biggest texture GD ships with
+    static constexpr size_t SLOT_SIZE = 4096 * 4096 * 4;
+
+    std::array<Slot, 3> m_slots;
+    asp::Mutex<> m_mutex;
+    std::atomic_bool m_active = false;
+
+    std::optional<size_t> acquireSlot();
+    // Frees slots whose uploads have finished. If `wait` is true, blocks until all uploads are done.
+    void retire(bool wait);
+    void destroyBuffers();
+};
+
+}
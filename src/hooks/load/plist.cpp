@@ -0,0 +1,909 @@
+#include "plist.hpp"
+#include <util/string.hpp>
+#include <util/hash.hpp>
+#include <util.hpp>
+#include <tracing.hpp>
+
+#include <settings.hpp>
+
+#include <asp/simd.hpp>
+#include <asp/sync/Mutex.hpp>
+
+#include <Geode/loader/Log.hpp>
+#include <Geode/Prelude.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include <thread>
+
+#ifdef ASP_IS_X86
+# include <immintrin.h>
+#elif defined(ASP_IS_ARM64)
+# include <arm_neon.h>
+#endif
+
+using namespace geode::prelude;
+
+namespace blaze {
+
+namespace {
+    // frames are only split into chunks if each chunk gets at least this many
+    constexpr size_t MIN_FRAMES_PER_CHUNK = 512;
+
+    asp::Mutex<asp::ThreadPool*> g_parsePool{nullptr};
+
+    using find_byte_impl_t = const char* (*)(const char*, const char*, char);
+
+    const char* findByteScalar(const char* p, const char* end, char c) {
+        auto res = std::memchr(p, c, end - p);
+        return res ? static_cast<const char*>(res) : end;
+    }
+
+#ifdef ASP_IS_X86
+
+    BLAZE_SSE2 const char* findByteSSE2(const char* p, const char* end, char c) {
+        __m128i needle = _mm_set1_epi8(c);
+
+        for (; p + sizeof(__m128i) <= end; p += sizeof(__m128i)) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+
+            if (mask) return p + std::countr_zero(mask);
+        }
+
+        return findByteScalar(p, end, c);
+    }
+
+    BLAZE_AVX2 const char* findByteAVX2(const char* p, const char* end, char c) {
+        __m256i needle = _mm256_set1_epi8(c);
+
+        for (; p + sizeof(__m256i) <= end; p += sizeof(__m256i)) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+
+            if (mask) return p + std::countr_zero(mask);
+        }
+
+        return findByteScalar(p, end, c);
+    }
+
+#elif defined(ASP_IS_ARM64)
+
+    const char* findByteNEON(const char* p, const char* end, char c) {
+        uint8x16_t needle = vdupq_n_u8(c);
+
+        for (; p + sizeof(uint8x16_t) <= end; p += sizeof(uint8x16_t)) {
+            uint8x16_t eq = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p)), needle);
+
+            // neon has no movemask, narrowing leaves 4 bits per byte instead
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+
+            if (mask) return p + (std::countr_zero(mask) >> 2);
+        }
+
+        return findByteScalar(p, end, c);
+    }
+
+#endif
+
+    find_byte_impl_t chooseImpl() {
+#ifdef ASP_IS_X86
+        auto& features = asp::simd::getFeatures();
+
+        if (features.avx2) {
+            return &findByteAVX2;
+        } else if (features.sse2) {
+            return &findByteSSE2;
+        }
+
+        return &findByteScalar;
+#elif defined(ASP_IS_ARM64)
+        return &findByteNEON;
+#else
+        return &findByteScalar;
+#endif
+    }
+
+    const char* findByte(const char* p, const char* end, char c) {
+        // thread-safe, parsers run on the loading pool and on the chunk workers at once
+        static const find_byte_impl_t impl = chooseImpl();
+
+        return impl(p, end, c);
+    }
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    }
+
+    bool isBlank(const char* p, const char* end) {
+        for (; p != end; p++) {
+            if (!isSpace(*p)) return false;
+        }
+
+        return true;
+    }
+
+    enum class TagKind {
+        Open, Close, SelfClose,
+    };
+
+    struct Tag {
+        TagKind kind;
+        std::string_view name;
+
+        bool is(std::string_view n) const {
+            return kind != TagKind::Close && name == n;
+        }
+    };
+
+    struct Text {
+        char* begin = nullptr;
+        char* end = nullptr;
+
+        bool empty() const {
+            return begin == end;
+        }
+
+        std::string_view view() const {
+            return {begin, end};
+        }
+    };
+
+    class Parser {
+    public:
+        Parser(char* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+        Result<> parse(SpriteFrameData& out) {
+            GEODE_UNWRAP(this->skipProlog());
+
+            GEODE_UNWRAP_INTO(auto plist, this->nextTag());
+            if (!plist.is("plist") || plist.kind == TagKind::SelfClose) {
+                return Err("Failed to find root <plist> node");
+            }
+
+            GEODE_UNWRAP_INTO(auto root, this->nextTag());
+            if (!root.is("dict") || root.kind == TagKind::SelfClose) {
+                return Err("Failed to find root <dict> node");
+            }
+
+            bool hasMetadata = false;
+
+            while (true) {
+                GEODE_UNWRAP_INTO(auto tag, this->nextTag());
+                if (tag.kind == TagKind::Close) break;
+
+                GEODE_UNWRAP_INTO(auto key, this->readKey(tag));
+                GEODE_UNWRAP_INTO(auto value, this->nextTag());
+                if (value.kind == TagKind::Close) break;
+
+                auto keyName = key.view();
+
+                if (keyName == "frames") {
+                    if (m_framesBegin || !value.is("dict") || value.kind == TagKind::SelfClose) {
+                        return Err("Unexpected 'frames' node");
+                    }
+
+                    // the format is stored after the frames, so only remember where they are for now
+                    m_framesBegin = m_pos;
+                    GEODE_UNWRAP(this->scanFrames());
+                } else if (keyName == "metadata") {
+                    if (hasMetadata || !value.is("dict") || value.kind == TagKind::SelfClose) {
+                        return Err("Unexpected 'metadata' node");
+                    }
+
+                    hasMetadata = true;
+                    GEODE_UNWRAP(this->parseMetadata(out.metadata));
+                } else {
+                    GEODE_UNWRAP(this->skipValue(value));
+                }
+            }
+
+            if (!m_framesBegin) {
+                return Err("Failed to find 'frames' node");
+            }
+
+            if (!hasMetadata) {
+                return Err("Failed to find 'metadata' node");
+            }
+
+            if (out.metadata.format < 0 || out.metadata.format > 3) {
+                return Err("Unsupported format version: {}", out.metadata.format);
+            }
+
+            return Ok();
+        }
+
+        // Parses the frames in this parser's range, which must contain only key/dict pairs.
+        Result<> parseFrames(std::vector<SpriteFrame>& out, int format) {
+            while (true) {
+                this->skipSpace();
+                if (m_pos == m_end) break;
+
+                GEODE_UNWRAP_INTO(auto tag, this->nextTag());
+                GEODE_UNWRAP_INTO(auto key, this->readKey(tag));
+
+                // a key without a value at the very end, pugixml ignores those too
+                this->skipSpace();
+                if (m_pos == m_end) break;
+
+                GEODE_UNWRAP_INTO(auto value, this->nextTag());
+                if (!value.is("dict")) {
+                    return Err("Unexpected <{}> in frames", value.name);
+                }
+
+                SpriteFrame frame;
+                frame.name = this->terminate(key);
+
+                GEODE_UNWRAP_INTO(bool ok, this->parseFrame(value, frame, format));
+
+                if (!ok) {
+                    m_skipped.push_back(key.view());
+                    continue;
+                }
+
+                out.push_back(std::move(frame));
+            }
+
+            return Ok();
+        }
+
+        void recordEntries(bool record) {
+            m_recordEntries = record;
+        }
+
+        // Where each frame's <key> starts, only filled if `recordEntries(true)` was called before parsing.
+        const std::vector<char*>& entries() const {
+            return m_entries;
+        }
+
+        // The contents of the frames dict, without its own tags
+        char* framesBegin() const {
+            return m_framesBegin;
+        }
+
+        char* framesEnd() const {
+            return m_framesEnd;
+        }
+
+        // Parses the whole file into the same objects that cocos' CCDictMaker would create.
+        // The root dictionary is returned with a refcount of 1 and nothing is autoreleased, so this is thread safe.
+        // The buffer is never modified.
+        Result<CCDictionary*> parseDictionary() {
+            GEODE_UNWRAP(this->skipProlog());
+
+            GEODE_UNWRAP_INTO(auto plist, this->nextTag());
+            if (!plist.is("plist") || plist.kind == TagKind::SelfClose) {
+                return Err("Failed to find root <plist> node");
+            }
+
+            GEODE_UNWRAP_INTO(auto root, this->nextTag());
+            if (!root.is("dict")) {
+                return Err("Failed to find root <dict> node");
+            }
+
+            GEODE_UNWRAP_INTO(auto object, this->readObject(root));
+            auto dict = static_cast<CCDictionary*>(object);
+
+            auto close = this->nextTag();
+            if (!close || close.unwrap().kind != TagKind::Close || close.unwrap().name != "plist" || !isBlank(m_pos, m_end)) {
+                dict->release();
+                return Err("Unexpected data after the root <dict>");
+            }
+
+            return Ok(dict);
+        }
+
+        // Null terminates all the strings that were handed out. Until this is called, the buffer is not modified.
+        void commit() {
+            for (char* p : m_terminators) {
+                *p = '\0';
+            }
+
+            // only warn now, so that nothing is logged twice if we bail and pugixml has to parse the file again
+            for (auto name : m_skipped) {
+                log::warn("Failed to parse frame '{}', skipping!", name);
+            }
+        }
+
+    private:
+        char* m_pos;
+        char* m_end;
+        std::vector<char*> m_terminators;
+        std::vector<std::string_view> m_skipped;
+        char* m_tagStart = nullptr;
+        char* m_framesBegin = nullptr;
+        char* m_framesEnd = nullptr;
+        bool m_recordEntries = false;
+        std::vector<char*> m_entries;
+
+        void skipSpace() {
+            while (m_pos != m_end && isSpace(*m_pos)) m_pos++;
+        }
+
+        char* find(char* p, char c) {
+            return const_cast<char*>(findByte(p, m_end, c));
+        }
+
+        char* find(char* p, std::string_view str) {
+            while (true) {
+                p = this->find(p, str[0]);
+                if (static_cast<size_t>(m_end - p) < str.size()) return m_end;
+                if (std::memcmp(p, str.data(), str.size()) == 0) return p;
+                p++;
+            }
+        }
+
+        bool startsWith(std::string_view str) const {
+            return static_cast<size_t>(m_end - m_pos) >= str.size() && std::memcmp(m_pos, str.data(), str.size()) == 0;
+        }
+
+        const char* terminate(Text text) {
+            if (text.empty()) return "";
+
+            m_terminators.push_back(text.end);
+            return text.begin;
+        }
+
+        Result<> skipProlog() {
+            if (this->startsWith("\xEF\xBB\xBF")) {
+                m_pos += 3;
+            }
+
+            while (true) {
+                this->skipSpace();
+
+                if (this->startsWith("<?")) {
+                    char* end = this->find(m_pos, "?>");
+                    if (end == m_end) return Err("Unterminated processing instruction");
+                    m_pos = end + 2;
+                } else if (this->startsWith("<!--")) {
+                    char* end = this->find(m_pos, "-->");
+                    if (end == m_end) return Err("Unterminated comment");
+                    m_pos = end + 3;
+                } else if (this->startsWith("<!DOCTYPE")) {
+                    char* end = this->find(m_pos, '>');
+                    if (end == m_end) return Err("Unterminated DOCTYPE");
+
+                    // internal subsets can declare entities, leave those to pugixml
+                    if (this->find(m_pos, '[') < end) return Err("Unsupported DOCTYPE");
+                    m_pos = end + 1;
+                } else if (this->startsWith("<") && !this->startsWith("<!")) {
+                    return Ok();
+                } else {
+                    return Err("Unexpected data before the root node");
+                }
+            }
+        }
+
+        // Reads the next tag. Unless `textAllowed` is true, fails if there is anything but whitespace before it.
+        Result<Tag> nextTag(bool textAllowed = false) {
+            char* lt = this->find(m_pos, '<');
+            if (lt == m_end) return Err("Unexpected end of file");
+
+            if (!textAllowed && !isBlank(m_pos, lt)) {
+                return Err("Unexpected text");
+            }
+
+            m_tagStart = lt;
+
+            char* p = lt + 1;
+            if (p == m_end) return Err("Unexpected end of file");
+
+            Tag tag{TagKind::Open, {}};
+
+            if (*p == '/') {
+                tag.kind = TagKind::Close;
+                p++;
+            } else if (*p == '!' || *p == '?') {
+                return Err("Unsupported markup");
+            }
+
+            char* nameStart = p;
+            while (p != m_end && !isSpace(*p) && *p != '/' && *p != '>') p++;
+            char* nameEnd = p;
+
+            if (nameStart == nameEnd) return Err("Empty tag name");
+            tag.name = std::string_view{nameStart, nameEnd};
+
+            // skip attributes, a '>' inside of quotes does not end the tag
+            while (true) {
+                if (p == m_end) return Err("Unexpected end of file");
+
+                char c = *p;
+                if (c == '>') break;
+
+                if (c == '"' || c == '\'') {
+                    p = this->find(p + 1, c);
+                    if (p == m_end) return Err("Unterminated attribute");
+                }
+
+                p++;
+            }
+
+            if (tag.kind == TagKind::Open && p - 1 >= nameEnd && p[-1] == '/') {
+                tag.kind = TagKind::SelfClose;
+            }
+
+            m_pos = p + 1;
+            return Ok(tag);
+        }
+
+        // Reads the text inside of an element that was just opened, and consumes its closing tag.
+        // Whitespace-only text is treated as empty, unless `keepBlank` is true, then it makes the parser bail.
+        Result<Text> readText(const Tag& open, bool keepBlank = false) {
+            if (open.kind == TagKind::SelfClose) return Ok(Text{});
+
+            char* start = m_pos;
+            char* lt = this->find(start, '<');
+
+            if (lt == m_end || lt + 1 == m_end) return Err("Unexpected end of file");
+            if (lt[1] != '/') return Err("Unexpected element inside of <{}>", open.name);
+
+            Text text{start, lt};
+
+            if (!text.empty() && isSpace(*start) && isBlank(start, lt)) {
+                // pugixml drops whitespace-only text, but cocos' own parser may not
+                if (keepBlank) return Err("Whitespace-only text in <{}>", open.name);
+                text = {};
+            } else if (text.view().find_first_of("&\r") != std::string_view::npos) {
+                // entities and line ending normalization are left to pugixml
+                return Err("Unsupported text in <{}>", open.name);
+            }
+
+            m_pos = lt;
+            GEODE_UNWRAP_INTO(auto close, this->nextTag());
+
+            if (close.kind != TagKind::Close || close.name != open.name) {
+                return Err("Mismatched closing tag for <{}>", open.name);
+            }
+
+            return Ok(text);
+        }
+
+        Result<Text> readKey(const Tag& tag, bool keepBlank = false) {
+            if (!tag.is("key")) {
+                return Err("Expected <key>, found <{}>", tag.name);
+            }
+
+            return this->readText(tag, keepBlank);
+        }
+
+        static CCString* makeString(std::string_view str) {
+            auto out = new CCString();
+            out->m_sString = gd::string{str.data(), str.size()};
+            return out;
+        }
+
+        // Reads a value that was just opened into a cocos object with a refcount of 1.
+        // Values are stored the same way as CCDictMaker does, as strings, with true and false becoming "1" and "0".
+        Result<CCObject*> readObject(const Tag& tag) {
+            if (tag.is("dict")) {
+                auto dict = new CCDictionary();
+
+                if (tag.kind != TagKind::SelfClose) {
+                    if (auto res = this->readDictContents(dict); !res) {
+                        dict->release();
+                        return Err(std::move(res).unwrapErr());
+                    }
+                }
+
+                return Ok(dict);
+            } else if (tag.is("array")) {
+                auto array = new CCArray();
+                array->init();
+
+                if (tag.kind != TagKind::SelfClose) {
+                    if (auto res = this->readArrayContents(array); !res) {
+                        array->release();
+                        return Err(std::move(res).unwrapErr());
+                    }
+                }
+
+                return Ok(array);
+            } else if (tag.is("true") || tag.is("false")) {
+                GEODE_UNWRAP(this->skipValue(tag));
+                return Ok(makeString(tag.name == "true" ? "1" : "0"));
+            } else if (tag.is("string") || tag.is("integer") || tag.is("real")) {
+                GEODE_UNWRAP_INTO(auto text, this->readText(tag, true));
+                return Ok(makeString(text.view()));
+            }
+
+            // cocos silently drops anything else (and its key), leave that to it
+            return Err("Unsupported value <{}>", tag.name);
+        }
+
+        Result<> readDictContents(CCDictionary* dict) {
+            while (true) {
+                GEODE_UNWRAP_INTO(auto tag, this->nextTag());
+                if (tag.kind == TagKind::Close) {
+                    if (tag.name != "dict") return Err("Mismatched closing tag for <dict>");
+                    return Ok();
+                }
+
+                GEODE_UNWRAP_INTO(auto key, this->readKey(tag, true));
+
+                // cocos would reuse the previous key here
+                if (key.empty()) return Err("Empty key");
+
+                GEODE_UNWRAP_INTO(auto value, this->nextTag());
+                if (value.kind == TagKind::Close) {
+                    // a key without a value is ignored
+                    if (value.name != "dict") return Err("Mismatched closing tag for <dict>");
+                    return Ok();
+                }
+
+                GEODE_UNWRAP_INTO(auto object, this->readObject(value));
+                dict->setObject(object, gd::string{key.begin, static_cast<size_t>(key.end - key.begin)});
+                object->release();
+            }
+        }
+
+        Result<> readArrayContents(CCArray* array) {
+            while (true) {
+                GEODE_UNWRAP_INTO(auto tag, this->nextTag());
+                if (tag.kind == TagKind::Close) {
+                    if (tag.name != "array") return Err("Mismatched closing tag for <array>");
+                    return Ok();
+                }
+
+                GEODE_UNWRAP_INTO(auto object, this->readObject(tag));
+                array->addObject(object);
+                object->release();
+            }
+        }
+
+        // Skips an element that was just opened, along with everything inside of it.
+        Result<> skipValue(const Tag& open) {
+            if (open.kind == TagKind::SelfClose) return Ok();
+
+            size_t depth = 1;
+
+            while (depth != 0) {
+                GEODE_UNWRAP_INTO(auto tag, this->nextTag(true));
+
+                if (tag.kind == TagKind::Open) {
+                    depth++;
+                } else if (tag.kind == TagKind::Close) {
+                    depth--;
+                }
+            }
+
+            return Ok();
+        }
+
+        Result<> parseMetadata(SpriteFrameData::Metadata& out) {
+            while (true) {
+                GEODE_UNWRAP_INTO(auto tag, this->nextTag());
+                if (tag.kind == TagKind::Close) break;
+
+                GEODE_UNWRAP_INTO(auto key, this->readKey(tag));
+                GEODE_UNWRAP_INTO(auto value, this->nextTag());
+                if (value.kind == TagKind::Close) break;
+
+                switch (blaze::hashStringRuntime(key.view())) {
+                    case BLAZE_STRING_HASH("format"): {
+                        GEODE_UNWRAP_INTO(auto text, this->readText(value));
+                        out.format = blaze::parseInt(text.view()).value_or(-1);
+                    } break;
+
+                    case BLAZE_STRING_HASH("textureFileName"): {
+                        GEODE_UNWRAP_INTO(auto text, this->readText(value));
+                        out.textureFileName = this->terminate(text);
+                    } break;
+
+                    default: {
+                        GEODE_UNWRAP(this->skipValue(value));
+                    } break;
+                }
+            }
+
+            return Ok();
+        }
+
+        // Skips over the frames dict, remembering where it ends and (optionally) where every frame starts.
+        // Also makes sure that it only has key/dict pairs, so that it can be safely split at any key.
+        Result<> scanFrames() {
+            size_t depth = 1;
+            bool expectKey = true;
+
+            while (true) {
+                GEODE_UNWRAP_INTO(auto tag, this->nextTag(depth > 1));
+
+                if (tag.kind == TagKind::Close) {
+                    if (--depth == 0) break;
+                    continue;
+                }
+
+                if (depth == 1) {
+                    if (!tag.is(expectKey ? "key" : "dict")) {
+                        return Err("Unexpected <{}> in frames", tag.name);
+                    }
+
+                    if (expectKey && m_recordEntries) {
+                        m_entries.push_back(m_tagStart);
+                    }
+
+                    expectKey = !expectKey;
+                }
+
+                if (tag.kind == TagKind::Open) {
+                    depth++;
+                }
+            }
+
+            m_framesEnd = m_tagStart;
+            return Ok();
+        }
+
+        // Returns false if a value could not be parsed, the frame is skipped in that case (but still has to be consumed).
+        Result<bool> parseFrame(const Tag& dict, SpriteFrame& frame, int format) {
+            if (dict.kind == TagKind::SelfClose) return Ok(true);
+
+            bool ok = true;
+
+            while (true) {
+                GEODE_UNWRAP_INTO(auto tag, this->nextTag());
+                if (tag.kind == TagKind::Close) break;
+
+                GEODE_UNWRAP_INTO(auto key, this->readKey(tag));
+                GEODE_UNWRAP_INTO(auto value, this->nextTag());
+                if (value.kind == TagKind::Close) break;
+
+                if (!ok) {
+                    GEODE_UNWRAP(this->skipValue(value));
+                    continue;
+                }
+
+                GEODE_UNWRAP_INTO(ok, this->parseFrameValue(blaze::hashStringRuntime(key.view()), value, frame, format));
+            }
+
+            return Ok(ok);
+        }
+
+        template <typename T>
+        Result<std::optional<T>> readValue(const Tag& value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                GEODE_UNWRAP(this->skipValue(value));
+                return Ok(value.name == "true");
+            } else {
+                GEODE_UNWRAP_INTO(auto text, this->readText(value));
+                auto str = text.view();
+
+                if constexpr (std::is_same_v<T, float>) {
+                    return Ok(blaze::parseFloat(str));
+                } else if constexpr (std::is_same_v<T, int>) {
+                    return Ok(blaze::parseInt(str));
+                } else if constexpr (std::is_same_v<T, CCPoint> || std::is_same_v<T, CCSize>) {
+                    return Ok(blaze::parseCCPoint<T>(str));
+                } else if constexpr (std::is_same_v<T, CCRect>) {
+                    return Ok(str.empty() ? std::nullopt : blaze::parseCCRect(str));
+                } else {
+                    static_assert(std::is_void_v<T>, "unsupported type");
+                }
+            }
+        }
+
+#define read_or_bail(var, T) { \
+            GEODE_UNWRAP_INTO(auto _res, this->readValue<T>(value)); \
+            if (!_res) return Ok(false); \
+            var = *_res; \
+        }
+
+        Result<bool> parseFrameValue(uint32_t key, const Tag& value, SpriteFrame& frame, int format) {
+            if (format == 0) {
+                switch (key) {
+                    case BLAZE_STRING_HASH("x"): read_or_bail(frame.textureRect.origin.x, float); break;
+                    case BLAZE_STRING_HASH("y"): read_or_bail(frame.textureRect.origin.y, float); break;
+                    case BLAZE_STRING_HASH("width"): read_or_bail(frame.textureRect.size.width, float); break;
+                    case BLAZE_STRING_HASH("height"): read_or_bail(frame.textureRect.size.height, float); break;
+                    case BLAZE_STRING_HASH("offsetX"): read_or_bail(frame.offset.x, float); break;
+                    case BLAZE_STRING_HASH("offsetY"): read_or_bail(frame.offset.y, float); break;
+
+                    case BLAZE_STRING_HASH("originalWidth"): {
+                        read_or_bail(frame.sourceSize.width, int);
+                        frame.sourceSize.width = std::abs(frame.sourceSize.width);
+                    } break;
+
+                    case BLAZE_STRING_HASH("originalHeight"): {
+                        read_or_bail(frame.sourceSize.height, int);
+                        frame.sourceSize.height = std::abs(frame.sourceSize.height);
+                    } break;
+
+                    default: GEODE_UNWRAP(this->skipValue(value)); break;
+                }
+            } else if (format == 1 || format == 2) {
+                switch (key) {
+                    case BLAZE_STRING_HASH("frame"): read_or_bail(frame.textureRect, CCRect); break;
+                    case BLAZE_STRING_HASH("offset"): read_or_bail(frame.offset, CCPoint); break;
+                    case BLAZE_STRING_HASH("sourceSize"): read_or_bail(frame.sourceSize, CCSize); break;
+
+                    case BLAZE_STRING_HASH("rotated"): {
+                        if (format == 2) {
+                            read_or_bail(frame.textureRotated, bool);
+                        } else {
+                            GEODE_UNWRAP(this->skipValue(value));
+                        }
+                    } break;
+
+                    default: GEODE_UNWRAP(this->skipValue(value)); break;
+                }
+            } else {
+                switch (key) {
+                    case BLAZE_STRING_HASH("spriteOffset"): read_or_bail(frame.offset, CCPoint); break;
+                    case BLAZE_STRING_HASH("spriteSourceSize"): read_or_bail(frame.sourceSize, CCSize); break;
+                    case BLAZE_STRING_HASH("textureRect"): read_or_bail(frame.textureRect, CCRect); break;
+                    case BLAZE_STRING_HASH("textureRotated"): read_or_bail(frame.textureRotated, bool); break;
+                    case BLAZE_STRING_HASH("aliases"): GEODE_UNWRAP(this->readAliases(value, frame)); break;
+                    default: GEODE_UNWRAP(this->skipValue(value)); break;
+                }
+            }
+
+            return Ok(true);
+        }
+
+#undef read_or_bail
+
+        Result<> readAliases(const Tag& array, SpriteFrame& frame) {
+            if (!array.is("array")) {
+                return Err("Unexpected <{}> in aliases", array.name);
+            }
+
+            if (array.kind == TagKind::SelfClose) return Ok();
+
+            while (true) {
+                GEODE_UNWRAP_INTO(auto tag, this->nextTag());
+                if (tag.kind == TagKind::Close) break;
+
+                if (!tag.is("string")) {
+                    return Err("Unexpected <{}> in aliases", tag.name);
+                }
+
+                GEODE_UNWRAP_INTO(auto text, this->readText(tag));
+                frame.aliases.push_back(this->terminate(text));
+            }
+
+            return Ok();
+        }
+    };
+}
+
+namespace {
+    struct ParallelFrames {
+        struct Chunk {
+            Parser parser;
+            std::vector<SpriteFrame> frames;
+            std::optional<std::string> error;
+
+            Chunk(Parser parser) : parser(std::move(parser)) {}
+        };
+
+        std::vector<Chunk> chunks;
+        int format;
+        std::atomic_size_t next = 0;
+        std::atomic_size_t remaining = 0;
+
+        // Parses chunks until there are none left to claim
+        void work() {
+            while (true) {
+                size_t i = next.fetch_add(1, std::memory_order::relaxed);
+                if (i >= chunks.size()) return;
+
+                auto& chunk = chunks[i];
+                auto res = chunk.parser.parseFrames(chunk.frames, format);
+                if (!res) {
+                    chunk.error = std::move(res).unwrapErr();
+                }
+
+                remaining.fetch_sub(1, std::memory_order::release);
+            }
+        }
+    };
+
+    size_t chunkCount(size_t frames) {
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        return std::min(threads, frames / MIN_FRAMES_PER_CHUNK);
+    }
+
+    Result<> parseFramesParallel(Parser& parser, SpriteFrameData& out, size_t chunkCount) {
+        ZoneScoped;
+
+        auto& entries = parser.entries();
+        auto state = std::make_shared<ParallelFrames>();
+        state->format = out.metadata.format;
+        state->chunks.reserve(chunkCount);
+        state->remaining = chunkCount;
+
+        for (size_t i = 0; i < chunkCount; i++) {
+            size_t first = i * entries.size() / chunkCount;
+            size_t last = (i + 1) * entries.size() / chunkCount;
+            char* end = last < entries.size() ? entries[last] : parser.framesEnd();
+
+            state->chunks.emplace_back(Parser{entries[first], static_cast<size_t>(end - entries[first])});
+        }
+
+        {
+            auto pool = g_parsePool.lock();
+            if (*pool) {
+                for (size_t i = 1; i < chunkCount; i++) {
+                    (*pool)->pushTask([state] {
+                        state->work();
+                    });
+                }
+            }
+        }
+
+        // the calling thread helps out too, and takes any chunk that no worker got to yet,
+        // so this can't deadlock even if it's called from a pool thread while all the others are busy
+        state->work();
+
+        {
+            ZoneScopedN("Wait for frame chunks");
+
+            while (state->remaining.load(std::memory_order::acquire) != 0) {
+                std::this_thread::yield();
+            }
+        }
+
+        size_t total = 0;
+        for (auto& chunk : state->chunks) {
+            if (chunk.error) return Err(std::move(*chunk.error));
+            total += chunk.frames.size();
+        }
+
+        out.frames.reserve(total);
+
+        for (auto& chunk : state->chunks) {
+            std::move(chunk.frames.begin(), chunk.frames.end(), std::back_inserter(out.frames));
+            chunk.parser.commit();
+        }
+
+        return Ok();
+    }
+}
+
+Result<CCDictionary*> parsePlistDictionary(const void* data, size_t size) {
+    ZoneScoped;
+
+    // the parser only writes into the buffer on commit, which is never called here
+    Parser parser{const_cast<char*>(static_cast<const char*>(data)), size};
+    return parser.parseDictionary();
+}
+
+void setPlistParsePool(asp::ThreadPool* pool) {
+    *g_parsePool.lock() = pool;
+}
+
+Result<std::unique_ptr<SpriteFrameData>> parseSpriteFramesStreaming(void* data, size_t size, bool ownBuffer) {
+    ZoneScoped;
+
+    auto sfdata = std::make_unique<SpriteFrameData>();
+
+    bool parallel = blaze::settings().parallelPlist && *g_parsePool.lock() != nullptr;
+
+    Parser parser{static_cast<char*>(data), size};
+    parser.recordEntries(parallel);
+    GEODE_UNWRAP(parser.parse(*sfdata));
+
+    size_t chunks = parallel ? chunkCount(parser.entries().size()) : 1;
+
+    if (chunks > 1) {
+        GEODE_UNWRAP(parseFramesParallel(parser, *sfdata, chunks));
+    } else {
+        Parser frames{parser.framesBegin(), static_cast<size_t>(parser.framesEnd() - parser.framesBegin())};
+        GEODE_UNWRAP(frames.parseFrames(sfdata->frames, sfdata->metadata.format));
+        frames.commit();
+    }
+
+    parser.commit();
+
+    if (ownBuffer) {
+        sfdata->storage = std::shared_ptr<void>(data, pugi::get_memory_deallocation_function());
+    }
+
+    return Ok(std::move(sfdata));
+}
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Streaming parser for cocos2d sprite frame plists.
+//
+// Goes over the file in a single pass (plus one cheap skip over the frames dict, since the format is only known once
+// the metadata is read), using SIMD to jump between tags, and writes `SpriteFrame` records directly without building a DOM.
+// It only accepts the subset of XML that these plists actually use. Anything else (entities, CDATA, comments in the body,
+// unexpected text or nesting) makes it bail, and `parseSpriteFrames` then falls back to pugixml.
+//
+// The same parser also turns general plists into CCDictionaries, for everything else that GD loads (see `parsePlistDictionary`).
+//
+// With the `parallel-plist` setting, the skip over the frames dict also records where every frame starts,
+// and big sheets are split into chunks that get parsed concurrently on the load thread pool.
+
+#include "spriteframes.hpp"
+
+#include <asp/thread/ThreadPool.hpp>
+
+namespace blaze {
+
+// Parses sprite frames without pugixml. On failure the buffer is left untouched and is not freed, even if `ownBuffer` is true.
+geode::Result<std::unique_ptr<SpriteFrameData>> parseSpriteFramesStreaming(void* data, size_t size, bool ownBuffer = false);
+
+// Parses any plist with a root dictionary into cocos objects, the same ones `CCDictionary::createWithContentsOfFile` gives.
+// The dictionary is returned with a refcount of 1 and nothing is autoreleased, so this can be called from any thread.
+// Fails on anything cocos might parse differently (entities, whitespace-only values, unknown value types),
+// so the caller should fall back to cocos then.
+geode::Result<cocos2d::CCDictionary*> parsePlistDictionary(const void* data, size_t size);
+
+// Sets the thread pool used for parsing large plists in parallel, or disables that if null.
+// The pool must not be destroyed before this is called again with null.
+void setPlistParsePool(asp::ThreadPool* pool);
+
+}
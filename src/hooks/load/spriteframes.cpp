@@ -1,4 +1,6 @@
 #include "spriteframes.hpp"
+#include "plist.hpp"
+#include "../CCSpriteFrameCache.hpp"
 #include <util/string.hpp>
 #include <util/hash.hpp>
 #include <util.hpp>
@@ -33,100 +35,6 @@ namespace {
 
 namespace blaze {
 
-template <typename T = CCPoint>
-std::optional<T> parseCCPoint(std::string_view str) {
-    // A point is formatted in form {x,y}.
-    // Cocos does a bunch of unnecessary checks here, we are just going to go by the following rules:
-    // * First character has to be an opening brace
-    // * First number is parsed after the first brace
-    // * At the end of the first number, a comma must be present
-    // * Second number is parsed after the comma
-    // * At the end of the second number, a closing brace must be present
-    float x = 0.f, y = 0.f;
-
-    if (str.size() < 5) {
-        return std::nullopt;
-    }
-
-    if (str[0] != '{') {
-        return std::nullopt;
-    }
-
-    auto result = fast_float::from_chars(&str[1], &*str.end(), x);
-    if (result.ec != std::errc{}) {
-        return std::nullopt;
-    }
-
-    auto postFirstNumber = result.ptr;
-    if (*postFirstNumber != ',') {
-        return std::nullopt;
-    }
-
-    auto postComma = postFirstNumber + 1;
-    result = fast_float::from_chars(postComma, &*str.end(), y);
-
-    if (result.ec != std::errc{}) {
-        return std::nullopt;
-    }
-
-    auto postSecondNumber = result.ptr;
-    if (*postSecondNumber != '}') {
-        return std::nullopt;
-    }
-
-    return T{x, y};
-}
-
-std::optional<CCRect> parseCCRect(std::string_view str) {
-    // A rect is formatted as {{x,y},{w,h}}.
-    // We are going to go by the following rules:
-    // * First character has to be an opening brace, and last character has to be a closing brace
-    // * We find the index of the second comma, and split the string into two substrings (omitting the very first and very last braces)
-    // * Call parseCCPoint on both substrings and use their results
-
-    CCPoint origin;
-    CCSize size;
-
-    if (str[0] != '{' || str[str.size() - 1] != '}') {
-        return std::nullopt;
-    }
-
-    size_t secondCommaIdx = 0;
-    bool isFirstComma = true;
-    for (size_t i = 0; i < str.size(); i++) {
-        char c = str[i];
-        if (c == ',') {
-            if (isFirstComma) {
-                isFirstComma = false;
-            } else {
-                secondCommaIdx = i;
-                break;
-            }
-        }
-    }
-
-    if (secondCommaIdx == 0) {
-        return std::nullopt;
-    }
-
-    auto originStr = str.substr(1, secondCommaIdx - 1);
-    auto sizeStr = str.substr(secondCommaIdx + 1, str.size() - secondCommaIdx - 2);
-
-    if (auto x = parseCCPoint(originStr)) {
-        origin = x.value();
-    } else {
-        return std::nullopt;
-    }
-
-    if (auto x = parseCCPoint<CCSize>(sizeStr)) {
-        size = x.value();
-    } else {
-        return std::nullopt;
-    }
-
-    return CCRect{origin, size};
-}
-
 template <typename T>
 std::optional<T> parseNode(pugi::xml_node node) {
     auto str = node.child_value();
@@ -307,6 +215,19 @@ bool parseSpriteFrame(pugi::xml_node node, SpriteFrame& sframe, int format) {
 }
 
 Result<std::unique_ptr<SpriteFrameData>> parseSpriteFrames(void* data, size_t size, bool ownBuffer) {
+    auto res = parseSpriteFramesStreaming(data, size, ownBuffer);
+    if (res) {
+        return res;
+    }
+
+#ifdef BLAZE_DEBUG
+    log::debug("Streaming plist parser bailed ({}), falling back to pugixml", res.unwrapErr());
+#endif
+
+    return parseSpriteFramesPugi(data, size, ownBuffer);
+}
+
+Result<std::unique_ptr<SpriteFrameData>> parseSpriteFramesPugi(void* data, size_t size, bool ownBuffer) {
     auto sfdata = std::make_unique<SpriteFrameData>();
 
     pugi::xml_parse_result result;
@@ -415,13 +336,15 @@ Result<std::unique_ptr<SpriteFrameData>> parseSpriteFrames(void* data, size_t si
     return Ok(std::move(sfdata));
 }
 
-void addSpriteFrames(const SpriteFrameData& frames, cocos2d::CCTexture2D* texture) {
-    auto sfcache = CCSpriteFrameCache::get();
+SpriteFrameBatch createSpriteFrames(const SpriteFrameData& frames, cocos2d::CCTexture2D* texture) {
+    SpriteFrameBatch batch;
+    batch.data = &frames;
+    batch.slab = std::make_unique<SpriteFrameSlab>(frames.frames.size());
+    batch.sources.reserve(frames.frames.size());
 
     for (const auto& frame : frames.frames) {
         // create sprite frame
-        auto spriteFrame = new CCSpriteFrame();
-        bool result = spriteFrame->initWithTexture(
+        auto spriteFrame = batch.slab->emplace(
             texture,
             frame.textureRect,
             frame.textureRotated,
@@ -429,13 +352,28 @@ void addSpriteFrames(const SpriteFrameData& frames, cocos2d::CCTexture2D* textur
             frame.sourceSize
         );
 
-        if (!result) {
-            spriteFrame->release();
+        if (!spriteFrame) {
             log::warn("Failed to initialize sprite frame for {}", frame.name);
             continue;
         }
 
-        // add sprite frame
+        batch.sources.push_back(&frame);
+    }
+
+    return batch;
+}
+
+void insertSpriteFrames(SpriteFrameBatch batch) {
+    auto sfcache = CCSpriteFrameCache::get();
+
+    for (size_t i = 0; i < batch.sources.size(); i++) {
+        const auto& frame = *batch.sources[i];
+
+        // add sprite frame, the slab keeps its own reference so there is nothing to release here
+        auto spriteFrame = batch.slab->at(i);
+        // sheets loaded after the table was built can replace frames in it, and setObject releases the old one
+        updateSpriteFrameTable(frame.name, spriteFrame);
+        g_spriteFrameIndex.set(internString(frame.name), spriteFrame);
         sfcache->m_pSpriteFrames->setObject(spriteFrame, frame.name);
 
         // if there are any aliases, add them as well
@@ -450,11 +388,15 @@ void addSpriteFrames(const SpriteFrameData& frames, cocos2d::CCTexture2D* textur
                 );
             }
         }
-
-        spriteFrame->release();
     }
 
-    sfcache->m_pLoadedFileNames->insert(frames.metadata.textureFileName);
+    sfcache->m_pLoadedFileNames->insert(batch.data->metadata.textureFileName);
+
+    registerSpriteFrameSlab(std::move(batch.slab));
+}
+
+void addSpriteFrames(const SpriteFrameData& frames, cocos2d::CCTexture2D* texture) {
+    insertSpriteFrames(createSpriteFrames(frames, texture));
 }
 
 void addSpriteFramesVanilla(cocos2d::CCDictionary* dict, cocos2d::CCTexture2D* texture) {
@@ -4,6 +4,8 @@
 // Does very minimal heap allocations, uses fast XML and float parsers.
 // Proves to be ~8-9 times faster than the cocos2d implementation (on Windows)
 
+#include "frameslab.hpp"
+
 #include <pugixml.hpp>
 
 #include <Geode/Result.hpp>
@@ -29,12 +31,33 @@ struct SpriteFrameData {
     } metadata;
 
     pugi::xml_document doc;
+    // when loaded from the binary cache, keeps the mapping that the strings point into alive
+    std::shared_ptr<const void> storage;
     std::vector<SpriteFrame> frames;
 };
 
 // Parses data from a .plist file into a structure holding many sprite frames.
+// Uses the streaming parser, and falls back to pugixml if the plist has anything the streaming parser does not handle.
 geode::Result<std::unique_ptr<SpriteFrameData>> parseSpriteFrames(void* data, size_t size, bool ownBuffer = false);
 
+// Same as `parseSpriteFrames`, but always goes through pugixml.
+geode::Result<std::unique_ptr<SpriteFrameData>> parseSpriteFramesPugi(void* data, size_t size, bool ownBuffer = false);
+
+// Sprite frames that were created for a sheet, but not added to the cache yet.
+struct SpriteFrameBatch {
+    const SpriteFrameData* data = nullptr;
+    std::unique_ptr<SpriteFrameSlab> slab;
+    // the parsed frame for every frame in the slab, in the same order
+    std::vector<const SpriteFrame*> sources;
+};
+
+// Creates `CCSpriteFrame`s for all frames of a sheet. Doesn't touch the cache, so it can be done without holding `g_sfcacheMutex`.
+// `frames` must outlive the batch.
+SpriteFrameBatch createSpriteFrames(const SpriteFrameData& frames, cocos2d::CCTexture2D* texture);
+
+// Adds a batch of sprite frames to `CCSpriteFrameCache`. The caller is responsible for locking `g_sfcacheMutex`.
+void insertSpriteFrames(SpriteFrameBatch batch);
+
 // Adds sprite frames to `CCSpriteFrameCache` from a parsed `SpriteFrameData`.
 void addSpriteFrames(const SpriteFrameData& frames, cocos2d::CCTexture2D* texture);
 
@@ -3,6 +3,7 @@
 #include <algo/crc32.hpp>
 #include <formats.hpp>
 #include <tracing.hpp>
+#include <prefetch.hpp>
 #include <fpff.hpp>
 
 #include <Geode/loader/Log.hpp>
@@ -51,6 +52,8 @@ bool LoadManager::reallocFromCache(uint32_t checksum, uint8_t*& outbuf, size_t&
         return false;
     }
 
+    blaze::Prefetcher::get().noteFile(filep);
+
     std::error_code ec;
     auto fsize = std::filesystem::file_size(filep, ec);
 
@@ -77,8 +80,6 @@ void LoadManager::queueForCache(const std::filesystem::path& path, std::vector<u
 
 std::unique_ptr<uint8_t[]> LoadManager::readFile(const char* path, size_t& outSize, bool absolutePath) {
     ZoneScoped;
-    blaze::ThreadSafeFileUtilsGuard _guard;
-
 #ifdef GEODE_IS_ANDROID
     unsigned long s;
     auto buf = CCFileUtils::get()->getFileData(path, "rb", &s);
@@ -98,6 +99,8 @@ std::unique_ptr<uint8_t[]> LoadManager::readFile(const char* path, size_t& outSi
         return nullptr;
     }
 
+    blaze::Prefetcher::get().noteFile(std::string_view{fp.c_str(), fp.size()});
+
     // get the file size
     file.seekg(0, std::ios::end);
     outSize = file.tellg();
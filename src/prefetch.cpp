@@ -0,0 +1,185 @@
+#include "prefetch.hpp"
+
+#include <settings.hpp>
+#include <tracing.hpp>
+
+#include <Geode/loader/Dirs.hpp>
+#include <Geode/loader/Log.hpp>
+#include <Geode/loader/Mod.hpp>
+#include <Geode/Prelude.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <thread>
+
+#ifdef GEODE_IS_WINDOWS
+# include <Windows.h>
+#else
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+using namespace geode::prelude;
+
+namespace blaze {
+
+static std::filesystem::path listPath() {
+    return Mod::get()->getSaveDir() / "prefetch-list.txt";
+}
+
+void Prefetcher::start() {
+    if (!blaze::settings().ioPrefetch) return;
+
+    m_recording.store(true, std::memory_order::relaxed);
+
+    std::thread([this] {
+        utils::thread::setName("Blaze I/O Prefetch");
+
+        // save files are read by GameManager right away, so they go first
+        std::vector<std::filesystem::path> files = {
+            dirs::getSaveDir() / "CCGameManager.dat",
+            dirs::getSaveDir() / "CCLocalLevels.dat",
+        };
+
+        std::ifstream list(listPath());
+        std::string line;
+        while (std::getline(list, line)) {
+            if (line.empty()) continue;
+            files.emplace_back(std::u8string{line.begin(), line.end()});
+        }
+
+        this->prefetchAll(std::move(files));
+    }).detach();
+}
+
+void Prefetcher::noteFile(const std::filesystem::path& path) {
+    if (!m_recording.load(std::memory_order::relaxed)) return;
+
+    auto recorded = m_recorded.lock();
+    if (recorded->seen.insert(std::filesystem::hash_value(path)).second) {
+        recorded->files.push_back(path);
+    }
+}
+
+void Prefetcher::finish() {
+    if (!m_recording.exchange(false, std::memory_order::relaxed)) return;
+
+    m_stopped.store(true, std::memory_order::relaxed);
+    this->releaseHandles();
+
+    auto files = std::move(m_recorded.lock()->files);
+
+    std::thread([files = std::move(files)] {
+        std::ofstream list(listPath(), std::ios::out | std::ios::trunc);
+        if (!list.is_open()) {
+            log::warn("Failed to save the prefetch list");
+            return;
+        }
+
+        for (auto& file : files) {
+            auto str = file.u8string();
+            list.write(reinterpret_cast<const char*>(str.data()), str.size());
+            list.put('\n');
+        }
+    }).detach();
+}
+
+void Prefetcher::prefetchAll(std::vector<std::filesystem::path> files) {
+    ZoneScoped;
+
+    // files are in the order they were read last time, which is also roughly the order they will be read now
+    for (auto& file : files) {
+        if (m_stopped.load(std::memory_order::relaxed)) break;
+
+        this->prefetchFile(file);
+    }
+}
+
+#ifdef GEODE_IS_WINDOWS
+
+void Prefetcher::prefetchFile(const std::filesystem::path& path) {
+    HANDLE file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    // the view keeps the mapping and the file alive
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return;
+
+    // PrefetchVirtualMemory only queues the reads, the view must stay mapped until they are done
+    WIN32_MEMORY_RANGE_ENTRY entry {
+        .VirtualAddress = view,
+        .NumberOfBytes = static_cast<SIZE_T>(size.QuadPart),
+    };
+
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+
+    auto handles = m_handles.lock();
+    if (m_stopped.load(std::memory_order::relaxed)) {
+        // loading finished while we were prefetching
+        UnmapViewOfFile(view);
+    } else {
+        handles->push_back(view);
+    }
+}
+
+void Prefetcher::releaseHandles() {
+    auto handles = m_handles.lock();
+
+    for (void* view : *handles) {
+        UnmapViewOfFile(view);
+    }
+
+    handles->clear();
+}
+
+#else
+
+void Prefetcher::prefetchFile(const std::filesystem::path& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return;
+
+# ifdef GEODE_IS_MACOS
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        radvisory advisory {
+            .ra_offset = 0,
+            .ra_count = static_cast<int>(std::min<off_t>(st.st_size, INT_MAX)),
+        };
+
+        fcntl(fd, F_RDADVISE, &advisory);
+    }
+# else
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+# endif
+
+    // the readahead continues after the descriptor is closed
+    close(fd);
+}
+
+void Prefetcher::releaseHandles() {}
+
+#endif
+
+}
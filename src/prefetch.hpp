@@ -0,0 +1,52 @@
+#pragma once
+
+// Page cache prefetching.
+//
+// Every file read through `LoadManager` during loading is remembered, and on the next launch all of them
+// (plus the save files) are hinted to the OS right at the start of `startPreInit`, before the resource lists are even built.
+// The kernel then reads them in the background while GLFW, FMOD and GameManager are being set up,
+// so that by the time the loader needs the data it's usually already in memory. Matters most on cold boots from a HDD.
+
+#include <asp/sync/Mutex.hpp>
+#include <util.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <unordered_set>
+#include <vector>
+
+namespace blaze {
+
+class Prefetcher : public SingletonBase<Prefetcher> {
+    friend class SingletonBase;
+    Prefetcher() = default;
+
+public:
+    // Starts prefetching the files that were read during the previous launch, and starts recording the ones read during this one.
+    void start();
+
+    // Records a file that was read during loading. Can be called on any thread.
+    void noteFile(const std::filesystem::path& path);
+
+    // Stops recording, saves the file list for the next launch and releases everything used for prefetching.
+    void finish();
+
+private:
+    struct Recorded {
+        std::vector<std::filesystem::path> files;
+        std::unordered_set<size_t> seen; // std::filesystem::hash_value of the paths
+    };
+
+    std::atomic_bool m_recording = false;
+    std::atomic_bool m_stopped = false;
+    asp::Mutex<Recorded> m_recorded;
+
+    // platform specific handles that need to stay alive until loading is done (file mappings on windows)
+    asp::Mutex<std::vector<void*>> m_handles;
+
+    void prefetchAll(std::vector<std::filesystem::path> files);
+    void prefetchFile(const std::filesystem::path& path);
+    void releaseHandles();
+};
+
+}
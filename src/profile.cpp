@@ -0,0 +1,261 @@
+#include "profile.hpp"
+
+#include <settings.hpp>
+#include <util/hash.hpp>
+
+#include <Geode/loader/Log.hpp>
+#include <Geode/loader/Mod.hpp>
+#include <Geode/Prelude.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace geode::prelude;
+using namespace asp::time;
+
+namespace blaze {
+
+namespace {
+    constexpr uint32_t PROFILE_MAGIC = 0x504c4c42; // "BLLP"
+    constexpr uint32_t PROFILE_VERSION = 1;
+
+    // every this many launches, the pool size that was measured the longest time ago gets measured again
+    constexpr uint32_t POOL_RECHECK_INTERVAL = 16;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t launches;
+        uint32_t hardwareThreads;
+        uint32_t resourceCount;
+        uint32_t poolCount;
+    };
+
+    std::filesystem::path profilePath() {
+        return Mod::get()->getSaveDir() / "launch-profile.bin";
+    }
+
+    // Exponential moving average, so that a single unlucky launch doesn't throw everything off
+    float merge(float prev, float cur) {
+        if (prev <= 0.f) return cur;
+        if (cur <= 0.f) return prev;
+        return prev * 0.5f + cur * 0.5f;
+    }
+
+    std::vector<size_t> poolCandidates(uint32_t hw) {
+        std::vector<size_t> out;
+
+        for (size_t c : { (size_t) hw, std::max<size_t>(2, hw * 3 / 4), std::max<size_t>(2, hw / 2) }) {
+            if (std::find(out.begin(), out.end(), c) == out.end()) {
+                out.push_back(c);
+            }
+        }
+
+        return out;
+    }
+}
+
+void LaunchProfile::load() {
+    m_hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    m_poolSize = m_hardwareThreads;
+    m_enabled = blaze::settings().adaptiveLoading;
+
+    if (!m_enabled) return;
+
+    std::ifstream file(profilePath(), std::ios::in | std::ios::binary);
+    Header header{};
+
+    if (file.is_open() && file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        && header.magic == PROFILE_MAGIC && header.version == PROFILE_VERSION
+    ) {
+        std::vector<ResourceRecord> resources(header.resourceCount);
+        std::vector<PoolRecord> pools(header.poolCount);
+
+        file.read(reinterpret_cast<char*>(resources.data()), resources.size() * sizeof(ResourceRecord));
+        file.read(reinterpret_cast<char*>(pools.data()), pools.size() * sizeof(PoolRecord));
+
+        if (file) {
+            m_launches = header.launches;
+
+            for (auto& rec : resources) {
+                m_resources.emplace(rec.key, rec);
+            }
+
+            // measurements from a different cpu are useless
+            if (header.hardwareThreads == m_hardwareThreads) {
+                m_pools = std::move(pools);
+            }
+        } else {
+            log::warn("Launch profile is truncated, starting from scratch");
+        }
+    }
+
+    m_poolSize = this->choosePoolSize();
+}
+
+size_t LaunchProfile::choosePoolSize() const {
+    auto candidates = poolCandidates(m_hardwareThreads);
+
+    auto recordFor = [&](size_t threads) -> const PoolRecord* {
+        auto it = std::find_if(m_pools.begin(), m_pools.end(), [&](auto& rec) { return rec.threads == threads; });
+        return it == m_pools.end() ? nullptr : &*it;
+    };
+
+    // try every candidate at least once
+    for (size_t c : candidates) {
+        if (!recordFor(c)) return c;
+    }
+
+    auto cmp = [&](auto member) {
+        return [&, member](size_t a, size_t b) { return recordFor(a)->*member < recordFor(b)->*member; };
+    };
+
+    if ((m_launches + 1) % POOL_RECHECK_INTERVAL == 0) {
+        return *std::min_element(candidates.begin(), candidates.end(), cmp(&PoolRecord::lastLaunch));
+    }
+
+    return *std::min_element(candidates.begin(), candidates.end(), cmp(&PoolRecord::loadMs));
+}
+
+void LaunchProfile::save(Duration loadTime) {
+    if (!this->isEnabled()) return;
+
+    // anything loaded after this point is not part of the launch
+    m_enabled.store(false, std::memory_order::relaxed);
+
+    auto current = std::move(*m_current.lock());
+
+    // copy everything, the file is written in another thread
+    auto resources = m_resources;
+    auto pools = m_pools;
+    uint32_t launch = m_launches + 1;
+    uint32_t hardwareThreads = m_hardwareThreads;
+    uint32_t poolSize = m_poolSize;
+
+    std::thread([=, current = std::move(current), resources = std::move(resources), pools = std::move(pools)]() mutable {
+        utils::thread::setName("Blaze Profile Writer");
+
+        uint32_t hits = 0, misses = 0;
+
+        for (auto& [key, cur] : current) {
+            hits += cur.cacheHits;
+            misses += cur.cacheMisses;
+
+            auto [it, inserted] = resources.try_emplace(key, cur);
+            if (inserted) continue;
+
+            auto& rec = it->second;
+            rec.readUs = merge(rec.readUs, cur.readUs);
+            rec.decodeUs = merge(rec.decodeUs, cur.decodeUs);
+            rec.cachedDecodeUs = merge(rec.cachedDecodeUs, cur.cachedDecodeUs);
+            rec.uploadUs = merge(rec.uploadUs, cur.uploadUs);
+            rec.cacheHits += cur.cacheHits;
+            rec.cacheMisses += cur.cacheMisses;
+        }
+
+        float loadMs = loadTime.micros() / 1000.f;
+
+        auto pit = std::find_if(pools.begin(), pools.end(), [&](auto& rec) { return rec.threads == poolSize; });
+        if (pit == pools.end()) {
+            pools.push_back(PoolRecord { .threads = poolSize, .samples = 1, .lastLaunch = launch, .loadMs = loadMs });
+        } else {
+            pit->samples++;
+            pit->lastLaunch = launch;
+            pit->loadMs = merge(pit->loadMs, loadMs);
+        }
+
+        if (hits + misses != 0) {
+            log::info("Launch profile: {} threads, image cache hit rate {:.1f}%", poolSize, 100.f * hits / (hits + misses));
+        } else {
+            log::info("Launch profile: {} threads", poolSize);
+        }
+
+        Header header {
+            .magic = PROFILE_MAGIC,
+            .version = PROFILE_VERSION,
+            .launches = launch,
+            .hardwareThreads = hardwareThreads,
+            .resourceCount = (uint32_t) resources.size(),
+            .poolCount = (uint32_t) pools.size(),
+        };
+
+        // write into a temporary file first, so that a crash midway can't leave a broken profile behind
+        auto path = profilePath();
+        auto tmpPath = path;
+        tmpPath += ".tmp";
+
+        {
+            std::ofstream file(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                log::warn("Failed to save the launch profile");
+                return;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (auto& [_, rec] : resources) {
+                file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            }
+            file.write(reinterpret_cast<const char*>(pools.data()), pools.size() * sizeof(PoolRecord));
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            log::warn("Failed to save the launch profile: {}", ec.message());
+            std::filesystem::remove(tmpPath, ec);
+        }
+    }).detach();
+}
+
+bool LaunchProfile::isEnabled() const {
+    return m_enabled.load(std::memory_order::relaxed);
+}
+
+size_t LaunchProfile::poolSize() const {
+    return m_poolSize;
+}
+
+void LaunchProfile::record(std::string_view path, Stage stage, Duration took) {
+    if (!this->isEnabled()) return;
+
+    uint32_t key = blaze::hashStringRuntime(path);
+    float us = took.micros();
+
+    auto current = m_current.lock();
+    auto& rec = (*current)[key];
+    rec.key = key;
+
+    switch (stage) {
+        case Stage::Read: rec.readUs = us; break;
+        case Stage::Decode: rec.decodeUs = us; break;
+        case Stage::CacheHit: rec.cachedDecodeUs = us; rec.cacheHits++; break;
+        case Stage::CacheMiss: rec.decodeUs = us; rec.cacheMisses++; break;
+        case Stage::Upload: rec.uploadUs = us; break;
+    }
+}
+
+std::optional<bool> LaunchProfile::cacheVerdict(std::string_view path) const {
+    auto it = m_resources.find(blaze::hashStringRuntime(path));
+    if (it == m_resources.end()) return std::nullopt;
+
+    auto& rec = it->second;
+    if (rec.decodeUs <= 0.f || rec.cachedDecodeUs <= 0.f) return std::nullopt;
+
+    return rec.cachedDecodeUs < rec.decodeUs;
+}
+
+uint64_t LaunchProfile::estimatedCost(std::string_view path) const {
+    auto it = m_resources.find(blaze::hashStringRuntime(path));
+    if (it == m_resources.end()) return 0;
+
+    auto& rec = it->second;
+    float decode = rec.cachedDecodeUs > 0.f && rec.decodeUs > 0.f
+        ? std::min(rec.decodeUs, rec.cachedDecodeUs)
+        : std::max(rec.decodeUs, rec.cachedDecodeUs);
+
+    return static_cast<uint64_t>(rec.readUs + decode);
+}
+
+}
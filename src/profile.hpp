@@ -0,0 +1,92 @@
+#pragma once
+
+// Launch profile, lets the loader learn from previous launches.
+//
+// During loading, the time it takes to read, decode and upload each resource is recorded, along with image cache hits
+// and the total load time for the used thread pool size. Once loading finishes, it is merged into the profile
+// saved in the mod save dir, and on the next launch the loader uses it to:
+// * start decoding the most expensive images first, so the pool doesn't end up waiting on one big sheet at the end,
+// * use the image cache only for files where it's actually faster than decoding the png (slow disks can make it slower),
+// * pick the thread pool size that resulted in the fastest launches on this machine.
+
+#include <asp/sync/Mutex.hpp>
+#include <asp/time/Duration.hpp>
+#include <util.hpp>
+
+#include <atomic>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace blaze {
+
+class LaunchProfile : public SingletonBase<LaunchProfile> {
+    friend class SingletonBase;
+    LaunchProfile() = default;
+
+public:
+    enum class Stage {
+        Read,
+        Decode,     // png decoded without looking at the image cache
+        CacheHit,   // decoded from the image cache
+        CacheMiss,  // png decoded after the image cache missed
+        Upload,
+    };
+
+    // Reads the saved profile and picks the settings for this launch. Must be called before any loading starts.
+    void load();
+
+    // Merges this launch into the profile and saves it in the background. `loadTime` is the time from launch to the menu.
+    void save(asp::time::Duration loadTime);
+
+    bool isEnabled() const;
+
+    // Thread pool size to use for this launch.
+    size_t poolSize() const;
+
+    // Records how long a stage took for the given resource. `path` is the full path of the file. Can be called on any thread.
+    void record(std::string_view path, Stage stage, asp::time::Duration took);
+
+    // Whether the image cache was faster than decoding the png for this file on previous launches,
+    // `std::nullopt` if there's not enough data yet. Can be called on any thread.
+    std::optional<bool> cacheVerdict(std::string_view path) const;
+
+    // Estimated time (in microseconds) the file takes to read and decode on a worker thread, 0 if unknown.
+    // Can be called on any thread.
+    uint64_t estimatedCost(std::string_view path) const;
+
+private:
+    struct ResourceRecord {
+        uint32_t key;
+        float readUs;
+        float decodeUs;
+        float cachedDecodeUs;
+        float uploadUs;
+        uint32_t cacheHits;
+        uint32_t cacheMisses;
+    };
+
+    struct PoolRecord {
+        uint32_t threads;
+        uint32_t samples;
+        uint32_t lastLaunch;
+        float loadMs;
+    };
+
+    std::atomic_bool m_enabled = false;
+    size_t m_poolSize = 0;
+    uint32_t m_launches = 0;
+    uint32_t m_hardwareThreads = 0;
+
+    // state from previous launches, immutable after `load`
+    std::unordered_map<uint32_t, ResourceRecord> m_resources;
+    std::vector<PoolRecord> m_pools;
+
+    // samples of the current launch
+    asp::Mutex<std::unordered_map<uint32_t, ResourceRecord>> m_current;
+
+    size_t choosePoolSize() const;
+};
+
+}
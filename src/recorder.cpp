@@ -0,0 +1,391 @@
+#include "recorder.hpp"
+
+#include <Geode/Geode.hpp>
+#include <asp/sync/Mutex.hpp>
+#include <util/thread.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace geode::prelude;
+
+namespace blaze::trace {
+
+std::atomic_bool g_recording = false;
+
+namespace {
+    enum class EventType : uint8_t {
+        Begin, End
+    };
+
+    struct Event {
+        const char* name;
+        uint64_t timestamp; // nanoseconds since s_epoch
+        EventType type;
+    };
+
+    // Only the owning thread writes into the buffer, `count` is published with release semantics so that the
+    // dumping thread can read everything up to it. Buffers are never freed, so late events from detached threads are harmless.
+    struct ThreadBuffer {
+        static constexpr size_t CAPACITY = 16384;
+
+        std::unique_ptr<Event[]> events = std::make_unique<Event[]>(CAPACITY);
+        std::atomic_size_t count = 0;
+        size_t tid = 0;
+        std::string name;
+        bool isMain = false;
+    };
+
+    auto s_epoch = std::chrono::steady_clock::now();
+    asp::Mutex<std::vector<std::unique_ptr<ThreadBuffer>>> s_buffers;
+    thread_local ThreadBuffer* t_buffer = nullptr;
+
+    uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_epoch).count();
+    }
+
+    ThreadBuffer* threadBuffer() {
+        if (!t_buffer) {
+            auto buf = std::make_unique<ThreadBuffer>();
+            buf->isMain = blaze::isMainThread();
+            buf->name = buf->isMain ? "Main" : utils::thread::getName();
+
+            auto buffers = s_buffers.lock();
+            buf->tid = buffers->size() + 1;
+            t_buffer = buf.get();
+            buffers->push_back(std::move(buf));
+        }
+
+        return t_buffer;
+    }
+
+    void record(const char* name, EventType type) {
+        // zones that outlive the recording don't get their end events, the snapshot may be read at any moment
+        if (!g_recording.load(std::memory_order::relaxed)) return;
+
+        auto buf = threadBuffer();
+        size_t idx = buf->count.load(std::memory_order::relaxed);
+        buf->events[idx % ThreadBuffer::CAPACITY] = Event { name, now(), type };
+        buf->count.store(idx + 1, std::memory_order::release);
+    }
+
+    // A snapshot of a single thread, with the events turned into non-overlapping segments
+    // labeled by the innermost zone that was active at the time.
+    struct Segment {
+        uint64_t start, end;
+        const char* name; // nullptr if no zone was active
+        bool blocked;
+    };
+
+    struct ThreadSnapshot {
+        const ThreadBuffer* buffer;
+        std::vector<Event> events;
+        std::vector<Segment> segments;
+    };
+
+    bool isWaitZone(const char* name) {
+        return std::string_view{name}.starts_with("Wait");
+    }
+
+    ThreadSnapshot snapshot(const ThreadBuffer& buf) {
+        ThreadSnapshot snap;
+        snap.buffer = &buf;
+
+        size_t count = buf.count.load(std::memory_order::acquire);
+        size_t first = count > ThreadBuffer::CAPACITY ? count - ThreadBuffer::CAPACITY : 0;
+
+        snap.events.reserve(count - first);
+        for (size_t i = first; i < count; i++) {
+            snap.events.push_back(buf.events[i % ThreadBuffer::CAPACITY]);
+        }
+
+        // if the buffer wrapped around, skip the end events that have lost their begin event
+        std::vector<const char*> stack;
+        uint64_t last = snap.events.empty() ? 0 : snap.events.front().timestamp;
+
+        for (auto& ev : snap.events) {
+            if (ev.timestamp > last) {
+                const char* top = stack.empty() ? nullptr : stack.back();
+                snap.segments.push_back(Segment {
+                    .start = last,
+                    .end = ev.timestamp,
+                    .name = top,
+                    // time outside of any zone is GD's own code on the main thread, and idling on the workers
+                    .blocked = top ? isWaitZone(top) : !buf.isMain,
+                });
+            }
+
+            last = ev.timestamp;
+
+            if (ev.type == EventType::Begin) {
+                stack.push_back(ev.name);
+            } else if (!stack.empty()) {
+                stack.pop_back();
+            }
+        }
+
+        return snap;
+    }
+
+    struct PathEntry {
+        size_t thread;
+        const char* name;
+        uint64_t start, end;
+    };
+
+    // Walks backwards from the end of the main thread. Whenever the current thread is blocked (idle or inside a "Wait" zone),
+    // the walk jumps to the most recently finished piece of work on another thread, which is most likely what it was waiting for.
+    std::vector<PathEntry> criticalPath(const std::vector<ThreadSnapshot>& threads, size_t mainIdx, uint64_t endTime) {
+        struct WorkEnd {
+            uint64_t end;
+            size_t thread;
+            size_t segment;
+        };
+
+        std::vector<WorkEnd> workEnds;
+        for (size_t t = 0; t < threads.size(); t++) {
+            auto& segs = threads[t].segments;
+            for (size_t s = 0; s < segs.size(); s++) {
+                if (!segs[s].blocked) workEnds.push_back({segs[s].end, t, s});
+            }
+        }
+
+        std::sort(workEnds.begin(), workEnds.end(), [](auto& a, auto& b) { return a.end < b.end; });
+
+        std::vector<PathEntry> path;
+        size_t thread = mainIdx;
+        uint64_t t = endTime;
+
+        auto push = [&](size_t thread, const char* name, uint64_t start, uint64_t end) {
+            // merge with the previous entry if it's a continuation of the same zone
+            if (!path.empty() && path.back().thread == thread && path.back().name == name && path.back().start == end) {
+                path.back().start = start;
+            } else {
+                path.push_back({thread, name, start, end});
+            }
+        };
+
+        while (true) {
+            auto& segs = threads[thread].segments;
+
+            // last segment that starts before t
+            auto it = std::partition_point(segs.begin(), segs.end(), [&](const Segment& s) { return s.start < t; });
+
+            bool blocked;
+            uint64_t blockedStart;
+            const char* name;
+
+            bool atStart = it == segs.begin();
+
+            if (atStart) {
+                // beginning of the recording, a worker could have been waiting for tasks from another thread
+                if (threads[thread].buffer->isMain) break;
+
+                blocked = true;
+                blockedStart = 0;
+                name = nullptr;
+            } else if ((--it)->end < t) {
+                // nothing was recorded between the segment and t
+                blocked = !threads[thread].buffer->isMain;
+                blockedStart = it->end;
+                name = nullptr;
+            } else {
+                blocked = it->blocked;
+                blockedStart = it->start;
+                name = it->name;
+            }
+
+            if (!blocked) {
+                push(thread, name, blockedStart, t);
+                t = blockedStart;
+                continue;
+            }
+
+            // find the latest work on another thread that finished while we were blocked
+            auto wit = std::upper_bound(workEnds.begin(), workEnds.end(), t, [](uint64_t t, const WorkEnd& w) { return t < w.end; });
+            const WorkEnd* found = nullptr;
+
+            while (wit != workEnds.begin()) {
+                --wit;
+                if (wit->end <= blockedStart) break;
+                if (wit->thread != thread) {
+                    found = &*wit;
+                    break;
+                }
+            }
+
+            if (found) {
+                auto& seg = threads[found->thread].segments[found->segment];
+                if (t > seg.end) push(thread, name, seg.end, t);
+
+                thread = found->thread;
+                t = seg.end;
+            } else if (!atStart) {
+                push(thread, name, blockedStart, t);
+                t = blockedStart;
+            } else {
+                break;
+            }
+        }
+
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    std::string_view threadName(const ThreadSnapshot& snap) {
+        return snap.buffer->name.empty() ? std::string_view{"Unnamed"} : std::string_view{snap.buffer->name};
+    }
+
+    // Names come from thread names and function signatures, which can contain anything
+    std::string jsonEscape(std::string_view str) {
+        std::string out;
+        out.reserve(str.size());
+
+        for (char c : str) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if ((unsigned char) c < 0x20) {
+                        out += fmt::format("\\u{:04x}", (unsigned char) c);
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+
+        return out;
+    }
+
+    void writeChromeTrace(const std::vector<ThreadSnapshot>& threads, const std::filesystem::path& path) {
+        std::ofstream out(path);
+        if (!out) {
+            log::warn("Failed to open {} for writing", path);
+            return;
+        }
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+        bool first = true;
+        auto sep = [&] {
+            if (!first) out << ",\n";
+            first = false;
+        };
+
+        for (auto& thread : threads) {
+            sep();
+            out << fmt::format(
+                R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+                thread.buffer->tid, jsonEscape(threadName(thread))
+            );
+
+            for (auto& ev : thread.events) {
+                sep();
+                out << fmt::format(
+                    R"({{"name":"{}","ph":"{}","pid":1,"tid":{},"ts":{:.3f}}})",
+                    jsonEscape(ev.name ? ev.name : ""), ev.type == EventType::Begin ? 'B' : 'E', thread.buffer->tid, ev.timestamp / 1000.0
+                );
+            }
+        }
+
+        out << "\n]}\n";
+    }
+
+    void writeReport(const std::vector<ThreadSnapshot>& threads, size_t mainIdx, uint64_t endTime, const std::filesystem::path& path) {
+        auto cpath = criticalPath(threads, mainIdx, endTime);
+        if (cpath.empty()) return;
+
+        uint64_t total = cpath.back().end - cpath.front().start;
+
+        std::string report = fmt::format(
+            "Critical path through the load phases ({:.3f}ms, {} entries)\n\n",
+            total / 1'000'000.0, cpath.size()
+        );
+
+        for (auto& entry : cpath) {
+            report += fmt::format(
+                "{:>10.3f}ms {:>10.3f}ms  {:<24} {}\n",
+                entry.start / 1'000'000.0,
+                (entry.end - entry.start) / 1'000'000.0,
+                threadName(threads[entry.thread]),
+                entry.name ? entry.name : "(no zone)"
+            );
+        }
+
+        std::ofstream out(path);
+        if (out) {
+            out << report;
+        } else {
+            log::warn("Failed to open {} for writing", path);
+        }
+
+        // log the biggest contributors
+        std::sort(cpath.begin(), cpath.end(), [](auto& a, auto& b) { return a.end - a.start > b.end - b.start; });
+
+        log::info("Startup critical path took {:.3f}ms, longest steps:", total / 1'000'000.0);
+        for (size_t i = 0; i < std::min<size_t>(cpath.size(), 5); i++) {
+            auto& entry = cpath[i];
+            log::info(
+                "- {} ({}): {:.3f}ms",
+                entry.name ? entry.name : "(no zone)",
+                threadName(threads[entry.thread]),
+                (entry.end - entry.start) / 1'000'000.0
+            );
+        }
+    }
+}
+
+void beginZone(const char* name) {
+    record(name, EventType::Begin);
+}
+
+void endZone(const char* name) {
+    record(name, EventType::End);
+}
+
+void start() {
+    g_recording.store(true, std::memory_order::relaxed);
+}
+
+void finish() {
+    if (!g_recording.exchange(false, std::memory_order::relaxed)) return;
+
+    uint64_t endTime = now();
+
+    // writing the files can take a bit, don't hold up the main thread with it
+    std::thread([endTime] {
+        utils::thread::setName("Blaze Trace Writer");
+
+        std::vector<ThreadSnapshot> threads;
+        std::optional<size_t> mainIdx;
+
+        {
+            auto buffers = s_buffers.lock();
+            for (auto& buf : *buffers) {
+                if (buf->isMain) mainIdx = threads.size();
+                threads.push_back(snapshot(*buf));
+            }
+        }
+
+        auto dir = Mod::get()->getSaveDir();
+
+        writeChromeTrace(threads, dir / "startup-trace.json");
+
+        if (mainIdx) {
+            writeReport(threads, *mainIdx, endTime, dir / "startup-critical-path.txt");
+        }
+
+        log::info("Startup trace saved to {}", dir / "startup-trace.json");
+    }).detach();
+}
+
+}
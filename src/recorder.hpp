@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+
+// Lightweight in-process trace recorder, backs `ZoneScoped` when Tracy is not compiled in.
+//
+// While recording, begin/end events of every zone are written into a fixed-size ring buffer owned by the current thread.
+// Once the game finishes loading, the events are dumped as a Chrome trace (`startup-trace.json` in the mod save dir,
+// can be opened in chrome://tracing or ui.perfetto.dev) together with the critical path through the load phases.
+//
+// Zones whose names start with "Wait" are treated as the thread being blocked on other threads,
+// which is what lets the critical path jump from the main thread into the workers it was waiting for.
+
+namespace blaze::trace {
+    extern std::atomic_bool g_recording;
+
+    void beginZone(const char* name);
+    void endZone(const char* name);
+
+    struct Zone {
+        const char* name;
+        bool active;
+
+        inline Zone(const char* name) : name(name), active(g_recording.load(std::memory_order::relaxed)) {
+            if (active) beginZone(name);
+        }
+
+        inline ~Zone() {
+            if (active) endZone(name);
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+    };
+
+    // Starts recording events.
+    void start();
+
+    // Stops recording, writes the trace and the critical path report in the background. Does nothing if not recording.
+    void finish();
+}
+
+#define BLAZE_TRACE_CONCAT_(a, b) a##b
+#define BLAZE_TRACE_CONCAT(a, b) BLAZE_TRACE_CONCAT_(a, b)
+#define BLAZE_TRACE_ZONE(name) ::blaze::trace::Zone BLAZE_TRACE_CONCAT(_blazeTraceZone, __LINE__){name}
@@ -20,6 +20,21 @@ namespace blaze {
             settings.uncompressedSaves = Mod::get()->getSettingValue<bool>("uncompressed-saves");
             settings.lowMemory = Mod::get()->getSettingValue<bool>("low-memory-mode");
             settings.loadMore = Mod::get()->getSettingValue<bool>("load-more");
+            settings.pboUpload = Mod::get()->getSettingValue<bool>("pbo-upload");
+            settings.lazySheets = Mod::get()->getSettingValue<bool>("lazy-sheets");
+            settings.startupTrace = Mod::get()->getSettingValue<bool>("startup-trace");
+            settings.adaptiveLoading = Mod::get()->getSettingValue<bool>("adaptive-loading");
+            settings.ioPrefetch = Mod::get()->getSettingValue<bool>("io-prefetch");
+            settings.spriteFrameCache = Mod::get()->getSettingValue<bool>("sprite-frame-cache");
+            settings.parallelPlist = Mod::get()->getSettingValue<bool>("parallel-plist");
+            settings.fastFonts = Mod::get()->getSettingValue<bool>("fast-fonts");
+            settings.parallelRotations = Mod::get()->getSettingValue<bool>("parallel-rotations");
+            settings.parallelMoves = Mod::get()->getSettingValue<bool>("parallel-moves");
+            settings.deferredSections = Mod::get()->getSettingValue<bool>("deferred-sections");
+            settings.collisionBroadphase = Mod::get()->getSettingValue<bool>("collision-broadphase");
+            settings.parallelSprites = Mod::get()->getSettingValue<bool>("parallel-sprites");
+            settings.partialUploads = Mod::get()->getSettingValue<bool>("partial-uploads");
+            settings.frameProfiler = Mod::get()->getSettingValue<bool>("frame-profiler");
         }
 
         return settings;
@@ -34,4 +49,10 @@ $execute {
     s_listen("fast-saving", fastSaving);
     s_listen("uncompressed-saves", uncompressedSaves);
     s_listen("low-memory-mode", lowMemory);
+    s_listen("parallel-rotations", parallelRotations);
+    s_listen("parallel-moves", parallelMoves);
+    s_listen("deferred-sections", deferredSections);
+    s_listen("collision-broadphase", collisionBroadphase);
+    s_listen("parallel-sprites", parallelSprites);
+    s_listen("partial-uploads", partialUploads);
 }
@@ -12,6 +12,21 @@ namespace blaze {
         bool uncompressedSaves = false;
         bool lowMemory = false;
         bool loadMore = false;
+        bool pboUpload = false;
+        bool lazySheets = false;
+        bool startupTrace = false;
+        bool adaptiveLoading = false;
+        bool ioPrefetch = false;
+        bool spriteFrameCache = false;
+        bool parallelPlist = false;
+        bool fastFonts = false;
+        bool parallelRotations = false;
+        bool parallelMoves = false;
+        bool deferredSections = false;
+        bool collisionBroadphase = false;
+        bool parallelSprites = false;
+        bool partialUploads = false;
+        bool frameProfiler = false;
     };
 
     _settings& settings();
@@ -1,15 +1,19 @@
 #include "tracing.hpp"
+#include "frameprof.hpp"
 
-#ifdef BLAZE_TRACY
+#include <Geode/Modify.hpp>
 
+#ifdef BLAZE_TRACY
 #include <TracyOpenGL.hpp>
 class GLFWwindow;
-#include <Geode/Modify.hpp>
+#endif
 
 using namespace geode::prelude;
 
 // A lot of this was taken from algebradash <3
 
+#ifdef BLAZE_TRACY
+
 #ifdef GEODE_IS_WINDOWS
 class $modify(CCEGLView) {
     bool initGlew() {
@@ -45,31 +49,44 @@ class $modify(CCEGLView) {
     }
 };
 #endif
+#endif // BLAZE_TRACY
+
+// The hooks below time functions for Tracy in Tracy builds, and for the in-game frame profiler (see frameprof.hpp).
+// Outside of Tracy builds they are only enabled while the frame profiler is on.
+
+#ifdef BLAZE_TRACY
+# define PROFILER_SCOPE(name) ZoneScopedN(name); BLAZE_FRAME_SCOPE(name)
+# define PROFILER_ON_MODIFY
+#else
+# define PROFILER_SCOPE(name) BLAZE_FRAME_SCOPE(name)
+# define PROFILER_ON_MODIFY static void onModify(auto& self) { \
+    for (auto& [name, hook] : self.m_hooks) ::blaze::frameprof::registerHook(hook.get()); }
+#endif
 
 #define PROFILER_HOOK_3(Ret_, Class_, Name_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_() { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(); } };
+    PROFILER_ON_MODIFY Ret_ Name_() { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(); } };
 #define PROFILER_HOOK_4(Ret_, Class_, Name_, A_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a); } };
 #define PROFILER_HOOK_5(Ret_, Class_, Name_, A_, B_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b); } };
 #define PROFILER_HOOK_6(Ret_, Class_, Name_, A_, B_, C_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b, C_ c) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b, c); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b, C_ c) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b, c); } };
 #define PROFILER_HOOK_7(Ret_, Class_, Name_, A_, B_, C_, D_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b, C_ c, D_ d) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b, C_ c, D_ d) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d); } };
 #define PROFILER_HOOK_8(Ret_, Class_, Name_, A_, B_, C_, D_, E_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e); } };
 #define PROFILER_HOOK_9(Ret_, Class_, Name_, A_, B_, C_, D_, E_, F_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f); } };
 #define PROFILER_HOOK_10(Ret_, Class_, Name_, A_, B_, C_, D_, E_, F_, G_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g); } };
 #define PROFILER_HOOK_11(Ret_, Class_, Name_, A_, B_, C_, D_, E_, F_, G_, H_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g, H_ h) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g, h); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g, H_ h) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g, h); } };
 #define PROFILER_HOOK_12(Ret_, Class_, Name_, A_, B_, C_, D_, E_, F_, G_, H_, I_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g, H_ h, I_ i) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g, h, i); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g, H_ h, I_ i) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g, h, i); } };
 #define PROFILER_HOOK_13(Ret_, Class_, Name_, A_, B_, C_, D_, E_, F_, G_, H_, I_, J_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g, H_ h, I_ i, J_ j) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g, h, i, j); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g, H_ h, I_ i, J_ j) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g, h, i, j); } };
 #define PROFILER_HOOK_14(Ret_, Class_, Name_, A_, B_, C_, D_, E_, F_, G_, H_, I_, J_, K_) class GEODE_CRTP2(GEODE_CONCAT(profilerHook, __LINE__), Class_) { \
-    Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g, H_ h, I_ i, J_ j, K_ k) { ZoneScopedN(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g, h, i, j, k); } };
+    PROFILER_ON_MODIFY Ret_ Name_(A_ a, B_ b, C_ c, D_ d, E_ e, F_ f, G_ g, H_ h, I_ i, J_ j, K_ k) { PROFILER_SCOPE(#Class_ "::" #Name_); return Class_::Name_(a, b, c, d, e, f, g, h, i, j, k); } };
 
 #define PROFILER_HOOK(...) GEODE_INVOKE(GEODE_CONCAT(PROFILER_HOOK_, GEODE_NUMBER_OF_ARGS(__VA_ARGS__)), __VA_ARGS__)
 
@@ -261,5 +278,3 @@ PROFILER_HOOK(void, CCNode, updateTransform)
 PROFILER_HOOK(int, CCApplication, run)
 GEODE_WINDOWS(PROFILER_HOOK(void, AppDelegate, setupGLView))
 
-
-#endif // BLAZE_TRACY
\ No newline at end of file
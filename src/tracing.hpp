@@ -3,7 +3,8 @@
 #ifdef BLAZE_TRACY
 # include <Tracy.hpp>
 #else
-# define ZoneScoped
-# define ZoneScopedN(arg)
+# include "recorder.hpp"
+# define ZoneScoped BLAZE_TRACE_ZONE(__FUNCTION__)
+# define ZoneScopedN(arg) BLAZE_TRACE_ZONE(arg)
 # define FrameMark
 #endif
@@ -0,0 +1,266 @@
+#pragma once
+
+// Sharded hash index with lock-free lookups, meant to sit in front of the cocos caches.
+//
+// Every shard is an open addressing table of pointers to immutable nodes. Lookups only do atomic loads,
+// while inserts and erases take the shard's lock, publish new nodes (or a bigger table) and retire whatever they replaced.
+// Lookups count themselves in a reader counter, and retired memory is freed after a write once the counter is zero.
+// Replacements are published before that check and lookups register before loading anything (both sequentially consistent),
+// so a lookup that the check misses can only ever see the new nodes, and a reader never ends up with a dangling node.
+// Memory retired while lookups are running stays around until a later write (or `collect()`) finds none.
+
+#include <asp/sync/Mutex.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace blaze {
+
+template <typename V, size_t ShardCount = 16>
+class ConcurrentIndex {
+public:
+    ConcurrentIndex() {
+        for (auto& shard : m_shards) {
+            shard.table.store(new Table(INITIAL_CAPACITY), std::memory_order::relaxed);
+        }
+    }
+
+    ~ConcurrentIndex() {
+        for (auto& shard : m_shards) {
+            auto data = shard.data.lock();
+            Table* table = shard.table.load(std::memory_order::relaxed);
+
+            this->retireNodes(*data, table);
+            data->tables.emplace_back(table);
+        }
+    }
+
+    ConcurrentIndex(const ConcurrentIndex&) = delete;
+    ConcurrentIndex& operator=(const ConcurrentIndex&) = delete;
+
+    // Lock-free, can be called from any thread at any time.
+    std::optional<V> find(std::string_view key, uint64_t hash) const {
+        ReadGuard guard{m_readers};
+
+        auto& shard = this->shardFor(hash);
+        const Table* table = shard.table.load(std::memory_order::seq_cst);
+
+        for (size_t i = hash & table->mask, probes = 0; probes <= table->mask; i = (i + 1) & table->mask, probes++) {
+            const Node* node = table->slots[i].load(std::memory_order::seq_cst);
+
+            if (!node) break;
+            if (node == tombstone()) continue;
+
+            if (node->hash == hash && node->key == key) {
+                return node->value;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    // Inserts or replaces the value for the key.
+    void insert(std::string_view key, uint64_t hash, V value) {
+        auto& shard = this->shardFor(hash);
+        auto data = shard.data.lock();
+
+        Table* table = shard.table.load(std::memory_order::relaxed);
+
+        // keep the load factor under 3/4, counting tombstones since they make probes longer too
+        if ((table->used + 1) * 4 > (table->mask + 1) * 3) {
+            table = this->grow(shard, *data, table);
+        }
+
+        auto node = new Node { hash, std::string{key}, std::move(value) };
+        std::atomic<Node*>* target = nullptr;
+
+        for (size_t i = hash & table->mask; ; i = (i + 1) & table->mask) {
+            Node* existing = table->slots[i].load(std::memory_order::relaxed);
+
+            if (!existing) {
+                if (!target) {
+                    target = &table->slots[i];
+                    table->used++;
+                }
+
+                break;
+            }
+
+            if (existing == tombstone()) {
+                if (!target) target = &table->slots[i];
+                continue;
+            }
+
+            if (existing->hash == hash && existing->key == key) {
+                table->slots[i].store(node, std::memory_order::seq_cst);
+                data->nodes.emplace_back(existing);
+                this->tryCollect(*data);
+                return;
+            }
+        }
+
+        target->store(node, std::memory_order::release);
+        this->tryCollect(*data);
+    }
+
+    void erase(std::string_view key, uint64_t hash) {
+        auto& shard = this->shardFor(hash);
+        auto data = shard.data.lock();
+
+        Table* table = shard.table.load(std::memory_order::relaxed);
+
+        for (size_t i = hash & table->mask, probes = 0; probes <= table->mask; i = (i + 1) & table->mask, probes++) {
+            Node* node = table->slots[i].load(std::memory_order::relaxed);
+
+            if (!node) return;
+            if (node == tombstone()) continue;
+
+            if (node->hash == hash && node->key == key) {
+                table->slots[i].store(tombstone(), std::memory_order::seq_cst);
+                data->nodes.emplace_back(node);
+                this->tryCollect(*data);
+                return;
+            }
+        }
+    }
+
+    // Removes everything. Readers that already loaded the old table keep seeing it until they are done.
+    void clear() {
+        for (auto& shard : m_shards) {
+            auto data = shard.data.lock();
+
+            Table* old = shard.table.exchange(new Table(INITIAL_CAPACITY), std::memory_order::seq_cst);
+            this->retireNodes(*data, old);
+            data->tables.emplace_back(old);
+            this->tryCollect(*data);
+        }
+    }
+
+    // Frees memory retired by inserts, erases and clears, unless a lookup is running right now.
+    // Writes already do this for their own shard, this is for when no more writes are coming.
+    void collect() {
+        for (auto& shard : m_shards) {
+            auto data = shard.data.lock();
+            this->tryCollect(*data);
+        }
+    }
+
+private:
+    static constexpr size_t INITIAL_CAPACITY = 64;
+
+    struct Node {
+        uint64_t hash;
+        std::string key;
+        V value;
+    };
+
+    struct Table {
+        size_t mask;
+        size_t used = 0; // occupied slots, including tombstones
+        std::unique_ptr<std::atomic<Node*>[]> slots;
+
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new std::atomic<Node*>[capacity]) {
+            for (size_t i = 0; i < capacity; i++) {
+                slots[i].store(nullptr, std::memory_order::relaxed);
+            }
+        }
+    };
+
+    struct Retired {
+        std::vector<std::unique_ptr<Node>> nodes;
+        std::vector<std::unique_ptr<Table>> tables;
+    };
+
+    struct alignas(64) Shard {
+        std::atomic<Table*> table;
+        asp::Mutex<Retired> data;
+    };
+
+    std::array<Shard, ShardCount> m_shards;
+    mutable std::atomic<size_t> m_readers{0};
+
+    struct ReadGuard {
+        std::atomic<size_t>& readers;
+
+        explicit ReadGuard(std::atomic<size_t>& readers) : readers(readers) {
+            readers.fetch_add(1, std::memory_order::seq_cst);
+        }
+
+        ~ReadGuard() {
+            readers.fetch_sub(1, std::memory_order::release);
+        }
+    };
+
+    // Must be called with the shard locked, after whatever was retired has been unpublished.
+    void tryCollect(Retired& retired) {
+        if (retired.nodes.empty() && retired.tables.empty()) return;
+        if (m_readers.load(std::memory_order::seq_cst) != 0) return;
+
+        retired.nodes.clear();
+        retired.tables.clear();
+    }
+
+    static Node* tombstone() {
+        static Node node{};
+        return &node;
+    }
+
+    Shard& shardFor(uint64_t hash) {
+        // the low bits pick the slot, so use the high ones for the shard
+        return m_shards[(hash >> 48) % ShardCount];
+    }
+
+    const Shard& shardFor(uint64_t hash) const {
+        return m_shards[(hash >> 48) % ShardCount];
+    }
+
+    // Moves all live nodes into a table twice the size (or the same size, if it's mostly tombstones) and publishes it.
+    Table* grow(Shard& shard, Retired& retired, Table* old) {
+        size_t live = 0;
+        for (size_t i = 0; i <= old->mask; i++) {
+            Node* node = old->slots[i].load(std::memory_order::relaxed);
+            if (node && node != tombstone()) live++;
+        }
+
+        size_t capacity = old->mask + 1;
+        if ((live + 1) * 2 > capacity) {
+            capacity *= 2;
+        }
+
+        auto table = new Table(capacity);
+
+        for (size_t i = 0; i <= old->mask; i++) {
+            Node* node = old->slots[i].load(std::memory_order::relaxed);
+            if (!node || node == tombstone()) continue;
+
+            size_t j = node->hash & table->mask;
+            while (table->slots[j].load(std::memory_order::relaxed)) {
+                j = (j + 1) & table->mask;
+            }
+
+            table->slots[j].store(node, std::memory_order::relaxed);
+            table->used++;
+        }
+
+        shard.table.store(table, std::memory_order::seq_cst);
+        retired.tables.emplace_back(old);
+
+        return table;
+    }
+
+    void retireNodes(Retired& retired, Table* table) {
+        for (size_t i = 0; i <= table->mask; i++) {
+            Node* node = table->slots[i].load(std::memory_order::relaxed);
+            if (node && node != tombstone()) {
+                retired.nodes.emplace_back(node);
+            }
+        }
+    }
+};
+
+}
@@ -22,4 +22,14 @@ uint32_t hashStringRuntime(std::string_view str) {
     return hash;
 }
 
+uint64_t hashStringRuntime64(std::string_view str) {
+    uint64_t hash = FNV_OFFSET_BASIS_64;
+
+    for (char c : str) {
+        hash = ((hash ^ static_cast<uint8_t>(c)) * FNV_PRIME_64);
+    }
+
+    return hash;
+}
+
 }
\ No newline at end of file
@@ -9,6 +9,8 @@ namespace blaze {
 
 constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
 constexpr uint32_t FNV_PRIME = 16777619u;
+constexpr uint64_t FNV_OFFSET_BASIS_64 = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME_64 = 1099511628211ull;
 
 constexpr uint32_t _fnv1a_hash(const char *str, uint32_t hash = FNV_OFFSET_BASIS) {
     return (*str == '\0') ? hash : _fnv1a_hash(str + 1, (hash ^ static_cast<uint8_t>(*str)) * FNV_PRIME);
@@ -19,4 +21,7 @@ constexpr uint32_t _fnv1a_hash(const char *str, uint32_t hash = FNV_OFFSET_BASIS
 uint32_t hashStringRuntime(const char* str);
 uint32_t hashStringRuntime(std::string_view str);
 
+// 64-bit variant, for tables where 32-bit collisions would be too common
+uint64_t hashStringRuntime64(std::string_view str);
+
 }
\ No newline at end of file
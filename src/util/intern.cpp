@@ -0,0 +1,100 @@
+#include "intern.hpp"
+#include "concurrent_index.hpp"
+#include "hash.hpp"
+#include "assert.hpp"
+
+#include <asp/sync/Mutex.hpp>
+#include <Geode/loader/Log.hpp>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace blaze {
+
+namespace {
+    constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
+    constexpr size_t MAX_STRING_IDS = IdMap<const char*>::MAX_SEGMENTS * IdMap<const char*>::SEGMENT_SIZE;
+
+    struct Arena {
+        std::vector<std::unique_ptr<char[]>> blocks;
+        size_t used = ARENA_BLOCK_SIZE;
+        StringId nextId = 0;
+
+        const char* copy(std::string_view str) {
+            size_t size = str.size() + 1;
+
+            char* out;
+            if (size > ARENA_BLOCK_SIZE / 4) {
+                // big strings get a block of their own
+                out = blocks.emplace_back(new char[size]).get();
+            } else {
+                if (used + size > ARENA_BLOCK_SIZE) {
+                    blocks.emplace_back(new char[ARENA_BLOCK_SIZE]);
+                    used = 0;
+                }
+
+                out = blocks.back().get() + used;
+                used += size;
+            }
+
+            std::memcpy(out, str.data(), str.size());
+            out[str.size()] = '\0';
+            return out;
+        }
+    };
+
+    ConcurrentIndex<StringId> g_ids;
+    IdMap<const char*> g_strings{nullptr};
+    asp::Mutex<Arena> g_arena;
+}
+
+StringId tryInternString(std::string_view str) {
+    uint64_t hash = hashStringRuntime64(str);
+
+    if (auto id = g_ids.find(str, hash)) {
+        return *id;
+    }
+
+    auto arena = g_arena.lock();
+
+    // someone else could have interned it while we were waiting for the lock
+    if (auto id = g_ids.find(str, hash)) {
+        return *id;
+    }
+
+    if (arena->nextId >= MAX_STRING_IDS) {
+        // only warn once
+        if (arena->nextId == MAX_STRING_IDS) {
+            geode::log::warn("String interner is full, new strings are no longer cached");
+            arena->nextId++;
+        }
+
+        return INVALID_STRING_ID;
+    }
+
+    StringId id = arena->nextId++;
+
+    // the string must be resolvable before the id can be found
+    g_strings.set(id, arena->copy(str));
+    g_ids.insert(str, hash, id);
+
+    return id;
+}
+
+StringId internString(std::string_view str) {
+    StringId id = tryInternString(str);
+    BLAZE_ASSERT(id != INVALID_STRING_ID);
+
+    return id;
+}
+
+StringId findInternedString(std::string_view str) {
+    return g_ids.find(str, hashStringRuntime64(str)).value_or(INVALID_STRING_ID);
+}
+
+const char* internedString(StringId id) {
+    return g_strings.get(id);
+}
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+// Global table of interned strings.
+//
+// Resource names (file names, full paths, sprite frame names) are hashed once when they are looked up and given a stable id,
+// and the caches that each used to hash and compare strings their own way (the path cache, the texture and sprite frame indices)
+// are plain arrays indexed by that id. Interned strings are never freed, so ids and the returned pointers stay valid forever.
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace blaze {
+
+using StringId = uint32_t;
+constexpr StringId INVALID_STRING_ID = 0xffffffff;
+
+// Returns the id of the string, interning it first if it's new. Thread safe.
+StringId internString(std::string_view str);
+
+// Same as `internString`, but returns `INVALID_STRING_ID` instead of aborting once all ids are used up.
+// For strings that come from outside and can be unbounded in number, such as file paths.
+StringId tryInternString(std::string_view str);
+
+// Returns the id of the string if it was interned before, `INVALID_STRING_ID` otherwise. Lock-free and does not allocate.
+StringId findInternedString(std::string_view str);
+
+// Returns the interned copy of the string (null terminated).
+const char* internedString(StringId id);
+
+// Lock-free map from string ids to small trivially copyable values, stored in lazily allocated segments.
+// Every read and write is a single atomic operation on the slot, so it can be used from any thread.
+template <typename V>
+class IdMap {
+public:
+    explicit IdMap(V empty = V{}) : m_empty(empty) {}
+
+    ~IdMap() {
+        for (auto& seg : m_segments) {
+            delete[] seg.load(std::memory_order::relaxed);
+        }
+    }
+
+    IdMap(const IdMap&) = delete;
+    IdMap& operator=(const IdMap&) = delete;
+
+    V get(StringId id) const {
+        if (id == INVALID_STRING_ID) return m_empty;
+
+        auto seg = m_segments[id >> SEGMENT_BITS].load(std::memory_order::acquire);
+        if (!seg) return m_empty;
+
+        return seg[id & SEGMENT_MASK].load(std::memory_order::acquire);
+    }
+
+    void set(StringId id, V value) {
+        if (id == INVALID_STRING_ID) return;
+
+        this->segment(id)[id & SEGMENT_MASK].store(value, std::memory_order::release);
+    }
+
+    // Resets every slot to the empty value. Segments are kept allocated.
+    void clear() {
+        for (auto& seg : m_segments) {
+            auto slots = seg.load(std::memory_order::acquire);
+            if (!slots) continue;
+
+            for (size_t i = 0; i < SEGMENT_SIZE; i++) {
+                slots[i].store(m_empty, std::memory_order::release);
+            }
+        }
+    }
+
+    static constexpr size_t SEGMENT_BITS = 12;
+    static constexpr size_t SEGMENT_SIZE = 1 << SEGMENT_BITS;
+    static constexpr size_t SEGMENT_MASK = SEGMENT_SIZE - 1;
+    static constexpr size_t MAX_SEGMENTS = 1024;
+
+private:
+    std::array<std::atomic<std::atomic<V>*>, MAX_SEGMENTS> m_segments{};
+    V m_empty;
+
+    std::atomic<V>* segment(StringId id) {
+        auto& slot = m_segments[id >> SEGMENT_BITS];
+
+        auto seg = slot.load(std::memory_order::acquire);
+        if (seg) return seg;
+
+        auto fresh = new std::atomic<V>[SEGMENT_SIZE];
+        for (size_t i = 0; i < SEGMENT_SIZE; i++) {
+            fresh[i].store(m_empty, std::memory_order::relaxed);
+        }
+
+        // another thread might have allocated it in the meantime
+        if (slot.compare_exchange_strong(seg, fresh, std::memory_order::acq_rel)) {
+            return fresh;
+        }
+
+        delete[] fresh;
+        return seg;
+    }
+};
+
+}
@@ -0,0 +1,106 @@
+#include "mapped_file.hpp"
+
+#include <Geode/platform/cplatform.h>
+#include <utility>
+
+#ifdef GEODE_IS_WINDOWS
+# include <Windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace blaze {
+
+MappedFile::MappedFile(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+MappedFile::~MappedFile() {
+    this->unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+    if (this != &other) {
+        this->unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+
+    return *this;
+}
+
+const uint8_t* MappedFile::data() const {
+    return m_data;
+}
+
+size_t MappedFile::size() const {
+    return m_size;
+}
+
+#ifdef GEODE_IS_WINDOWS
+
+std::optional<MappedFile> MappedFile::open(const std::filesystem::path& path) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return std::nullopt;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return std::nullopt;
+    }
+
+    // the view keeps both the mapping and the file alive
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return std::nullopt;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return std::nullopt;
+
+    return MappedFile{static_cast<const uint8_t*>(view), static_cast<size_t>(size.QuadPart)};
+}
+
+void MappedFile::unmap() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+#else
+
+std::optional<MappedFile> MappedFile::open(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return std::nullopt;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return std::nullopt;
+    }
+
+    void* mem = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mem == MAP_FAILED) return std::nullopt;
+
+    return MappedFile{static_cast<const uint8_t*>(mem), static_cast<size_t>(st.st_size)};
+}
+
+void MappedFile::unmap() {
+    if (m_data) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+#endif
+
+}
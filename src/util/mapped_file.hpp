@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace blaze {
+    // Read-only memory mapping of an entire file
+    class MappedFile {
+    public:
+        // Returns `std::nullopt` if the file does not exist, is empty or could not be mapped.
+        static std::optional<MappedFile> open(const std::filesystem::path& path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other);
+        MappedFile& operator=(MappedFile&& other);
+
+        const uint8_t* data() const;
+        size_t size() const;
+
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+
+        MappedFile(const uint8_t* data, size_t size);
+        void unmap();
+    };
+}
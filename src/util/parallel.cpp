@@ -0,0 +1,158 @@
+#include "parallel.hpp"
+
+#include <Geode/utils/thread.hpp>
+#include <asp/simd/CPUFeatures.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifdef ASP_IS_X86
+# include <immintrin.h>
+#endif
+
+namespace blaze {
+
+// the main thread plus this many workers, more than that stops helping for the kind of work done per tick
+static constexpr size_t MAX_WORKERS = 7;
+
+// how long a worker keeps spinning after a job before going to sleep
+static constexpr auto SPIN_TIME = std::chrono::microseconds(100);
+
+static inline void cpuRelax() {
+#if defined(ASP_IS_X86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+struct WorkerGroup::State {
+    size_t workerCount = 0;
+
+    // Written by the caller only while `generation` is odd and no worker is active.
+    BatchFn fn = nullptr;
+    void* ctx = nullptr;
+    size_t count = 0;
+    size_t batchSize = 0;
+    size_t batches = 0;
+
+    // Even when a job is published, odd while the next one is being written.
+    std::atomic<uint64_t> generation{0};
+    std::atomic<size_t> nextBatch{0};
+    std::atomic<size_t> doneBatches{0};
+    std::atomic<size_t> activeWorkers{0};
+
+    std::atomic<size_t> sleepers{0};
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+
+    // Claims and runs batches until there are none left.
+    void drain() {
+        while (true) {
+            size_t batch = nextBatch.fetch_add(1, std::memory_order::relaxed);
+            if (batch >= batches) return;
+
+            size_t begin = batch * batchSize;
+            size_t end = std::min(begin + batchSize, count);
+            fn(ctx, begin, end);
+
+            doneBatches.fetch_add(1, std::memory_order::release);
+        }
+    }
+
+    void workerMain() {
+        uint64_t seen = 0;
+
+        while (true) {
+            auto spinStart = std::chrono::steady_clock::now();
+            uint64_t gen;
+            size_t spins = 0;
+
+            while ((gen = generation.load(std::memory_order::acquire)) == seen || (gen & 1)) {
+                if (++spins % 64 != 0) {
+                    cpuRelax();
+                    continue;
+                }
+
+                if (std::chrono::steady_clock::now() - spinStart < SPIN_TIME) continue;
+
+                // nothing came in for a while, sleep until the next job
+                sleepers.fetch_add(1);
+                {
+                    std::unique_lock lock(sleepMutex);
+                    sleepCv.wait(lock, [&] {
+                        uint64_t g = generation.load();
+                        return g != seen && !(g & 1);
+                    });
+                }
+                sleepers.fetch_sub(1);
+                spinStart = std::chrono::steady_clock::now();
+            }
+
+            // the caller can start writing the next job at any point, so announce ourselves and check that this one is still current
+            activeWorkers.fetch_add(1);
+            if (generation.load() == gen) {
+                this->drain();
+                seen = gen;
+            }
+            activeWorkers.fetch_sub(1, std::memory_order::release);
+        }
+    }
+};
+
+WorkerGroup::WorkerGroup() : m_state(std::make_shared<State>()) {
+    size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    m_state->workerCount = std::min(hw - 1, MAX_WORKERS);
+
+    for (size_t i = 0; i < m_state->workerCount; i++) {
+        std::thread([state = m_state] {
+            geode::utils::thread::setName("Blaze Worker");
+            state->workerMain();
+        }).detach();
+    }
+}
+
+WorkerGroup::~WorkerGroup() {}
+
+size_t WorkerGroup::workerCount() const {
+    return m_state->workerCount;
+}
+
+void WorkerGroup::run(size_t count, size_t batchSize, BatchFn fn, void* ctx) {
+    auto& s = *m_state;
+
+    // retract the previous job and wait for anyone still looking at it
+    s.generation.fetch_add(1);
+    while (s.activeWorkers.load() != 0) {
+        cpuRelax();
+    }
+
+    s.fn = fn;
+    s.ctx = ctx;
+    s.count = count;
+    s.batchSize = batchSize;
+    s.batches = (count + batchSize - 1) / batchSize;
+    s.nextBatch.store(0, std::memory_order::relaxed);
+    s.doneBatches.store(0, std::memory_order::relaxed);
+
+    s.generation.fetch_add(1);
+
+    if (s.sleepers.load() != 0) {
+        // taking the lock makes sure a worker that is about to wait sees the new generation
+        { std::lock_guard lock(s.sleepMutex); }
+        s.sleepCv.notify_all();
+    }
+
+    s.drain();
+
+    while (s.doneBatches.load(std::memory_order::acquire) != s.batches) {
+        cpuRelax();
+    }
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+// Low latency fork-join for gameplay code.
+//
+// asp::ThreadPool is made for loading, where tasks are large and waking a sleeping thread is cheap in comparison.
+// Gameplay hooks split up work that takes well under a millisecond, several times per tick, so here the calling thread
+// works on the job too, and the workers spin for a little while after each job before going back to sleep.
+// A job is a range of indices split into fixed-size batches, which are claimed through a single atomic counter.
+//
+// Every index is processed exactly once, so as long as the work for different indices is independent,
+// the result is the same as that of a plain loop, regardless of which thread ends up running which batch.
+
+#include <util.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace blaze {
+
+class WorkerGroup : public SingletonBase<WorkerGroup> {
+    friend class SingletonBase;
+    WorkerGroup();
+
+public:
+    ~WorkerGroup();
+
+    // Calls `fn(begin, end)` for consecutive batches of at most `batchSize` indices covering [0, count),
+    // and returns once all of them are done. Small jobs are run directly on the calling thread.
+    // Not reentrant, and must only be called from one thread (in practice, the main thread).
+    template <typename F>
+    void parallelFor(size_t count, size_t batchSize, F&& fn) {
+        if (count == 0) return;
+
+        if (count <= batchSize || this->workerCount() == 0) {
+            fn(size_t(0), count);
+            return;
+        }
+
+        this->run(count, batchSize, [](void* ctx, size_t begin, size_t end) {
+            (*static_cast<std::remove_reference_t<F>*>(ctx))(begin, end);
+        }, &fn);
+    }
+
+    // Amount of threads besides the caller that work on jobs.
+    size_t workerCount() const;
+
+private:
+    using BatchFn = void(*)(void* ctx, size_t begin, size_t end);
+    struct State;
+
+    // shared with the worker threads, which are detached and may outlive this object at exit
+    std::shared_ptr<State> m_state;
+
+    void run(size_t count, size_t batchSize, BatchFn fn, void* ctx);
+};
+
+}
@@ -0,0 +1,97 @@
+#include "perfect_hash.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace blaze {
+
+// average keys per bucket, smaller buckets are quicker to place but cost more memory
+static constexpr size_t KEYS_PER_BUCKET = 3;
+static constexpr uint32_t MAX_DISPLACEMENT_TRIES = 1 << 24;
+
+std::optional<PerfectHash> PerfectHash::build(std::span<const uint64_t> hashes) {
+    PerfectHash phf;
+    phf.m_size = hashes.size();
+
+    if (hashes.empty()) {
+        return phf;
+    }
+
+    // duplicate hashes can never be separated
+    {
+        std::vector<uint64_t> sorted(hashes.begin(), hashes.end());
+        std::sort(sorted.begin(), sorted.end());
+
+        if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+            return std::nullopt;
+        }
+    }
+
+    size_t bucketCount = (hashes.size() + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+    phf.m_displacements.resize(bucketCount, 0);
+
+    // group the keys by bucket (counting sort)
+    std::vector<uint32_t> bucketStart(bucketCount + 1, 0);
+    for (uint64_t hash : hashes) {
+        bucketStart[reduce(hash, bucketCount) + 1]++;
+    }
+
+    std::partial_sum(bucketStart.begin(), bucketStart.end(), bucketStart.begin());
+
+    std::vector<uint64_t> grouped(hashes.size());
+    {
+        std::vector<uint32_t> cursor(bucketStart.begin(), bucketStart.end() - 1);
+        for (uint64_t hash : hashes) {
+            grouped[cursor[reduce(hash, bucketCount)]++] = hash;
+        }
+    }
+
+    // place the biggest buckets first, while most slots are still free
+    std::vector<uint32_t> order(bucketCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+    });
+
+    std::vector<uint8_t> taken(phf.m_size, 0);
+    std::vector<size_t> slots;
+
+    for (uint32_t bucket : order) {
+        size_t begin = bucketStart[bucket], end = bucketStart[bucket + 1];
+        if (begin == end) break;
+
+        bool placed = false;
+
+        for (uint32_t d = 0; d < MAX_DISPLACEMENT_TRIES && !placed; d++) {
+            slots.clear();
+            placed = true;
+
+            for (size_t i = begin; i < end; i++) {
+                size_t slot = reduce(mix(grouped[i], d), phf.m_size);
+
+                if (taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    placed = false;
+                    break;
+                }
+
+                slots.push_back(slot);
+            }
+
+            if (placed) {
+                phf.m_displacements[bucket] = d;
+            }
+        }
+
+        if (!placed) {
+            return std::nullopt;
+        }
+
+        for (size_t slot : slots) {
+            taken[slot] = 1;
+        }
+    }
+
+    return phf;
+}
+
+}
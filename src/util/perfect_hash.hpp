@@ -0,0 +1,48 @@
+#pragma once
+
+// Minimal perfect hash function over a fixed set of keys, built with the hash-and-displace scheme.
+//
+// Keys are hashed once by the caller (any good 64-bit hash), split into buckets of a few keys each,
+// and every bucket gets a displacement that sends all of its keys to distinct free slots.
+// Looking up a key is then a bucket load and a mix, with no probing and no branches.
+// Keys that were not in the set map to an arbitrary slot, so the caller has to compare the key stored there.
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace blaze {
+    class PerfectHash {
+    public:
+        // Returns `std::nullopt` if the hashes are not unique or no displacement could be found for some bucket.
+        static std::optional<PerfectHash> build(std::span<const uint64_t> hashes);
+
+        // Maps a hash to a slot in `[0, size())`. Must not be called if `size()` is 0.
+        size_t slot(uint64_t hash) const {
+            uint32_t displacement = m_displacements[reduce(hash, m_displacements.size())];
+            return reduce(mix(hash, displacement), m_size);
+        }
+
+        size_t size() const {
+            return m_size;
+        }
+
+    private:
+        std::vector<uint32_t> m_displacements;
+        size_t m_size = 0;
+
+        // maps the top 32 bits of the hash onto [0, n) with a multiply instead of a division
+        static size_t reduce(uint64_t hash, size_t n) {
+            return static_cast<size_t>(((hash >> 32) * n) >> 32);
+        }
+
+        static uint64_t mix(uint64_t hash, uint32_t displacement) {
+            uint64_t x = hash + displacement * 0x9e3779b97f4a7c15ull;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+            return x ^ (x >> 31);
+        }
+    };
+}
@@ -77,4 +77,94 @@ std::optional<int> parseInt(const cocos2d::CCString* str) {
     return parseInt(str->getCString());
 }
 
-}
\ No newline at end of file
+// Parses one component of a point, returns the pointer past the number or nullptr on failure.
+// Cocos uses `atof`, which goes through a double, so parse a double too to round to the exact same float.
+static const char* parsePointComponent(const char* begin, const char* end, float& out) {
+    if (begin == end) {
+        return nullptr;
+    }
+
+    // only plain decimal numbers, leaves inf, nan (and their payloads) and everything else to cocos
+    char first = *begin == '-' && end - begin > 1 ? begin[1] : *begin;
+    if ((first < '0' || first > '9') && first != '.') {
+        return nullptr;
+    }
+
+    double value = 0.0;
+    auto result = fast_float::from_chars(begin, end, value);
+    if (result.ec != std::errc{}) {
+        return nullptr;
+    }
+
+    out = static_cast<float>(value);
+    return result.ptr;
+}
+
+// Parses {x,y} at the start of the range, returns the pointer past the closing brace or nullptr on failure.
+static const char* parsePointAt(const char* begin, const char* end, float& x, float& y) {
+    if (begin == end || *begin != '{') {
+        return nullptr;
+    }
+
+    auto postFirstNumber = parsePointComponent(begin + 1, end, x);
+    if (!postFirstNumber || postFirstNumber == end || *postFirstNumber != ',') {
+        return nullptr;
+    }
+
+    auto postSecondNumber = parsePointComponent(postFirstNumber + 1, end, y);
+    if (!postSecondNumber || postSecondNumber == end || *postSecondNumber != '}') {
+        return nullptr;
+    }
+
+    return postSecondNumber + 1;
+}
+
+template <typename T>
+std::optional<T> parseCCPoint(std::string_view str) {
+    // A point is formatted in form {x,y}.
+    // Cocos does a bunch of unnecessary checks here, we are just going to go by the following rules:
+    // * First character has to be an opening brace
+    // * First number is parsed after the first brace
+    // * At the end of the first number, a comma must be present
+    // * Second number is parsed after the comma
+    // * At the end of the second number, a closing brace must be present
+    // Whatever comes after the closing brace is ignored, same as in cocos.
+    float x = 0.f, y = 0.f;
+
+    if (!parsePointAt(str.data(), str.data() + str.size(), x, y)) {
+        return std::nullopt;
+    }
+
+    return T{x, y};
+}
+
+template std::optional<CCPoint> parseCCPoint<CCPoint>(std::string_view);
+template std::optional<CCSize> parseCCPoint<CCSize>(std::string_view);
+
+std::optional<CCRect> parseCCRect(std::string_view str) {
+    // A rect is formatted as {{x,y},{w,h}}, and we only accept exactly that.
+    // Cocos looks for the third closing brace and splits the string around the comma after the first one,
+    // so any stray brace or comma changes its result in ways that are not worth replicating.
+    // Whatever comes after the last brace is ignored, same as in cocos.
+    float x = 0.f, y = 0.f, width = 0.f, height = 0.f;
+
+    const char* end = str.data() + str.size();
+
+    if (str.empty() || str[0] != '{') {
+        return std::nullopt;
+    }
+
+    auto postOrigin = parsePointAt(str.data() + 1, end, x, y);
+    if (!postOrigin || postOrigin == end || *postOrigin != ',') {
+        return std::nullopt;
+    }
+
+    auto postSize = parsePointAt(postOrigin + 1, end, width, height);
+    if (!postSize || postSize == end || *postSize != '}') {
+        return std::nullopt;
+    }
+
+    return CCRect{x, y, width, height};
+}
+
+}
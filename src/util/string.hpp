@@ -17,4 +17,13 @@ std::optional<int> parseInt(std::string_view str);
 std::optional<int> parseInt(const char* str);
 std::optional<int> parseInt(const cocos2d::CCString* str);
 
+// Parses a point or a size in the form of {x,y}, like `CCPointFromString` / `CCSizeFromString`.
+// Only the exact form is accepted, with no whitespace or hex / inf / nan numbers. Anything that is accepted
+// gives bit-identical results to the cocos functions, everything else should be left to them.
+template <typename T = cocos2d::CCPoint>
+std::optional<T> parseCCPoint(std::string_view str);
+
+// Parses a rect in the form of {{x,y},{w,h}}, like `CCRectFromString`. Same rules as `parseCCPoint` apply.
+std::optional<cocos2d::CCRect> parseCCRect(std::string_view str);
+
 }
\ No newline at end of file